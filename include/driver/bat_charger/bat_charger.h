@@ -18,10 +18,29 @@
 #include <zephyr/kernel.h>
 
 
+enum BAT_CHARGER_STATUS {
+   BAT_CHARGER_STATUS_NOT_CHARGING = 0,   // Charge complete, no battery or no input supply
+   BAT_CHARGER_STATUS_CHARGING,
+   BAT_CHARGER_STATUS_CNT,
+};
+
+/**
+ * @brief Status change callback. Runs in ISR context and must not block.
+ *
+ * @param[in] dev Battery charger driver device instance.
+ * @param[in] user_data User data given to bat_charger_set_callback().
+ */
+typedef void (*bat_charger_cb_t)(const struct device *dev, void *user_data);
+
 typedef int (*bat_charger_get_status_t)(const struct device *dev);
+typedef int (*bat_charger_set_callback_t)(const struct device *dev, bat_charger_cb_t cb, 
+    void *user_data);
+typedef int (*bat_charger_get_voltage_t)(const struct device *dev, uint32_t *voltage_mv);
 
 __subsystem struct bat_charger_api {
    bat_charger_get_status_t     get_status;
+   bat_charger_set_callback_t   set_callback;
+   bat_charger_get_voltage_t    get_voltage;
 };
 
 
@@ -31,8 +50,8 @@ __subsystem struct bat_charger_api {
  *
  * @param[in] dev Battery charger driver device instance.
  *
- * @retval 0 on success.
- * @retval Error code on failure.
+ * @retval Charging status on success, see enum BAT_CHARGER_STATUS.
+ * @retval Negative error code on failure.
  */
 __syscall int bat_charger_get_status(const struct device *dev);
 
@@ -42,6 +61,47 @@ static inline int z_impl_bat_charger_get_status(const struct device *dev)
     return api->get_status(dev);
 }
 
+/**
+ * @brief Sets the callback called whenever the charging status may have changed, e.g., 
+ *        on a STAT signal edge. Read the new status with bat_charger_get_status().
+ *
+ * @param[in] dev Battery charger driver device instance.
+ * @param[in] cb Status change callback, NULL to remove it.
+ * @param[in] user_data User data passed to the callback.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int bat_charger_set_callback(const struct device *dev, bat_charger_cb_t cb, 
+    void *user_data);
+
+static inline int z_impl_bat_charger_set_callback(const struct device *dev, 
+    bat_charger_cb_t cb, void *user_data)
+{
+    const struct bat_charger_api *api = (const struct bat_charger_api *)dev->api;
+    return api->set_callback(dev, cb, user_data);
+}
+
+/**
+ * @brief Gets the battery voltage, measured with an ADC channel when the charger node has 
+ *        'io-channels'. The conversion blocks until it completes.
+ *
+ * @param[in] dev Battery charger driver device instance.
+ * @param[out] voltage_mv Battery voltage in mV.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if the battery voltage is not measured.
+ * @retval Error code on failure.
+ */
+__syscall int bat_charger_get_voltage(const struct device *dev, uint32_t *voltage_mv);
+
+static inline int z_impl_bat_charger_get_voltage(const struct device *dev, 
+    uint32_t *voltage_mv)
+{
+    const struct bat_charger_api *api = (const struct bat_charger_api *)dev->api;
+    return api->get_voltage(dev, voltage_mv);
+}
+
 
 #include <syscalls/bat_charger.h>
 
@@ -18,13 +18,77 @@
 #include <zephyr/kernel.h>
 
 
+enum LED_DRIVERS_MODE {
+   LED_DRIVERS_MODE_NORMAL = 0,     // LED on at its level
+   LED_DRIVERS_MODE_BLINK,          // LED blinks at its level, timing set by set_blink
+   LED_DRIVERS_MODE_GRAD,           // LED ramps to/from its level, timing set by set_grad
+   LED_DRIVERS_MODE_CNT,
+};
+
+// LED image entry, level (0 to 63) and LED_DRIVERS_MODE of one LED. See 
+// led_drivers_set_image()
+#define LED_DRIVERS_IMG(lvl, mode)     ((uint8_t)(((mode) << 6) | (lvl)))
+#define LED_DRIVERS_IMG_LVL(img)       ((img) & 0x3F)
+#define LED_DRIVERS_IMG_MODE(img)      ((img) >> 6)
+
+struct led_drivers_stats {
+   uint32_t i2c_xfers;              // I2C write transactions
+   uint32_t i2c_bytes;              // I2C bytes sent, including addresses
+   uint32_t i2c_bytes_saved;        // I2C bytes skipped, the device already held the data
+   uint32_t async_errors;           // Asynchronous writes that failed on the bus
+   uint32_t async_dropped;          // Asynchronous writes dropped, the queue was full
+};
+
+/**
+ * @brief Asynchronous write error callback. Runs in the bus driver's ISR context and 
+ *        must not block.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] err Error code of the failed write.
+ * @param[in] user_data User data given to led_drivers_set_async_callback().
+ */
+typedef void (*led_drivers_async_cb_t)(const struct device *dev, int err, void *user_data);
+
+
 typedef int (*led_drivers_rst_t)(const struct device *dev);
 typedef int (*led_drivers_set_led_t)(const struct device *dev, const uint8_t led_num, 
     const uint8_t on_percent);
+typedef int (*led_drivers_set_led_level_t)(const struct device *dev, const uint8_t led_num, 
+    const uint8_t level);
+typedef int (*led_drivers_set_leds_t)(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t *levels);
+typedef int (*led_drivers_set_all_t)(const struct device *dev, const uint8_t level);
+typedef int (*led_drivers_set_image_t)(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t *image);
+typedef int (*led_drivers_set_mode_t)(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t mode);
+typedef int (*led_drivers_set_blink_t)(const struct device *dev, const uint16_t on_ms, 
+    const uint16_t period_ms);
+typedef int (*led_drivers_set_grad_t)(const struct device *dev, const uint16_t ramp_ms, 
+    const bool up);
+typedef int (*led_drivers_set_async_t)(const struct device *dev, const bool enable);
+typedef int (*led_drivers_set_async_callback_t)(const struct device *dev, 
+    led_drivers_async_cb_t cb, void *user_data);
+typedef int (*led_drivers_flush_t)(const struct device *dev, k_timeout_t timeout);
+typedef int (*led_drivers_set_supply_t)(const struct device *dev, const uint32_t supply_mv);
+typedef int (*led_drivers_get_stats_t)(const struct device *dev, 
+    struct led_drivers_stats *stats);
 
 __subsystem struct led_drivers_api {
    led_drivers_rst_t        rst;
    led_drivers_set_led_t    set_led;
+   led_drivers_set_led_level_t set_led_level;
+   led_drivers_set_leds_t   set_leds;
+   led_drivers_set_all_t    set_all;
+   led_drivers_set_image_t  set_image;
+   led_drivers_set_mode_t   set_mode;
+   led_drivers_set_blink_t  set_blink;
+   led_drivers_set_grad_t   set_grad;
+   led_drivers_set_async_t  set_async;
+   led_drivers_set_async_callback_t set_async_callback;
+   led_drivers_flush_t      flush;
+   led_drivers_set_supply_t set_supply;
+   led_drivers_get_stats_t  get_stats;
 };
 
 
@@ -62,6 +126,242 @@ static inline int z_impl_led_drivers_set_led(const struct device *dev,
     return api->set_led(dev, led_num, on_percent);
 }
 
+__syscall int led_drivers_set_led_level(const struct device *dev, const uint8_t led_num, 
+    const uint8_t level);
+
+static inline int z_impl_led_drivers_set_led_level(const struct device *dev, 
+    const uint8_t led_num, const uint8_t level)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_led_level(dev, led_num, level);
+}
+
+/**
+ * @brief Sets the levels of count consecutive LEDs in one bus transaction.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] first Number of the first LED to set.
+ * @param[in] count Number of LEDs to set.
+ * @param[in] levels LED levels, one per LED starting from first.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_leds(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t *levels);
+
+static inline int z_impl_led_drivers_set_leds(const struct device *dev, 
+    const uint8_t first, const uint8_t count, const uint8_t *levels)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_leds(dev, first, count, levels);
+}
+
+/**
+ * @brief Sets every LED of the device to the same level in one short bus transaction.
+ *        Every LED is put back in LED_DRIVERS_MODE_NORMAL.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] level LED level.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_all(const struct device *dev, const uint8_t level);
+
+static inline int z_impl_led_drivers_set_all(const struct device *dev, const uint8_t level)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_all(dev, level);
+}
+
+/**
+ * @brief Sets the level and mode of count consecutive LEDs from an image, e.g., a scene 
+ *        built at compile time. Only LEDs that differ from what the device holds are 
+ *        written, in a single bus transaction.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] first Number of the first LED to set.
+ * @param[in] count Number of LEDs to set.
+ * @param[in] image LED_DRIVERS_IMG() entries, one per LED starting from first.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_image(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t *image);
+
+static inline int z_impl_led_drivers_set_image(const struct device *dev, 
+    const uint8_t first, const uint8_t count, const uint8_t *image)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_image(dev, first, count, image);
+}
+
+/**
+ * @brief Sets the mode of count consecutive LEDs, their levels are kept. Blinking and 
+ *        gradation are run by the device itself: no CPU or bus activity once set.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] first Number of the first LED to set.
+ * @param[in] count Number of LEDs to set.
+ * @param[in] mode LED mode, see enum LED_DRIVERS_MODE.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_mode(const struct device *dev, const uint8_t first, 
+    const uint8_t count, const uint8_t mode);
+
+static inline int z_impl_led_drivers_set_mode(const struct device *dev, 
+    const uint8_t first, const uint8_t count, const uint8_t mode)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_mode(dev, first, count, mode);
+}
+
+/**
+ * @brief Sets the blink timing shared by all LEDs in LED_DRIVERS_MODE_BLINK. The device 
+ *        only supports a few timings, the closest one is used.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] on_ms LED on time per period in ms.
+ * @param[in] period_ms Blink period in ms.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_blink(const struct device *dev, const uint16_t on_ms, 
+    const uint16_t period_ms);
+
+static inline int z_impl_led_drivers_set_blink(const struct device *dev, 
+    const uint16_t on_ms, const uint16_t period_ms)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_blink(dev, on_ms, period_ms);
+}
+
+/**
+ * @brief Starts a gradation (fade) of all LEDs in LED_DRIVERS_MODE_GRAD, from off to their 
+ *        level or back. The device only supports a few ramp times, the closest one is used.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] ramp_ms Ramp time in ms, 0 to disable gradation.
+ * @param[in] up True to fade in, false to fade out.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_grad(const struct device *dev, const uint16_t ramp_ms, 
+    const bool up);
+
+static inline int z_impl_led_drivers_set_grad(const struct device *dev, 
+    const uint16_t ramp_ms, const bool up)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_grad(dev, ramp_ms, up);
+}
+
+/**
+ * @brief Enables or disables asynchronous writes. While enabled, the LED calls queue 
+ *        their bus writes and return without waiting for the bus; the writes complete in 
+ *        the background in order. Disabling waits for the queued writes to complete. 
+ *        The error callback set with led_drivers_set_async_callback() is kept.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] enable True to enable asynchronous writes.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if the bus driver does not support asynchronous transfers.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_async(const struct device *dev, const bool enable);
+
+static inline int z_impl_led_drivers_set_async(const struct device *dev, 
+    const bool enable)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_async(dev, enable);
+}
+
+/**
+ * @brief Sets the callback raised for every failed asynchronous write. Waits for the 
+ *        queued asynchronous writes to complete first.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] cb Callback raised for every failed write, NULL to remove it.
+ * @param[in] user_data User data passed to the callback.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if the device has no asynchronous writes.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_async_callback(const struct device *dev, 
+    led_drivers_async_cb_t cb, void *user_data);
+
+static inline int z_impl_led_drivers_set_async_callback(const struct device *dev, 
+    led_drivers_async_cb_t cb, void *user_data)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_async_callback(dev, cb, user_data);
+}
+
+/**
+ * @brief Waits for the queued asynchronous writes to complete.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] timeout Maximum time to wait.
+ *
+ * @retval 0 on success, also when asynchronous writes are disabled.
+ * @retval -EAGAIN if the timeout expired.
+ */
+__syscall int led_drivers_flush(const struct device *dev, k_timeout_t timeout);
+
+static inline int z_impl_led_drivers_flush(const struct device *dev, k_timeout_t timeout)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->flush(dev, timeout);
+}
+
+/**
+ * @brief Sets the LED supply voltage, e.g., the measured battery voltage. Devices with a 
+ *        charge pump use it to pick the most efficient mode for the LED levels set.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[in] supply_mv LED supply voltage in mV, 0 if unknown.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_set_supply(const struct device *dev, const uint32_t supply_mv);
+
+static inline int z_impl_led_drivers_set_supply(const struct device *dev, 
+    const uint32_t supply_mv)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->set_supply(dev, supply_mv);
+}
+
+/**
+ * @brief Gets the bus traffic statistics of the LED driver device. Writes that would not 
+ *        change a register are skipped and counted as saved.
+ *
+ * @param[in] dev LED drivers driver device instance.
+ * @param[out] stats Bus traffic statistics.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int led_drivers_get_stats(const struct device *dev, 
+    struct led_drivers_stats *stats);
+
+static inline int z_impl_led_drivers_get_stats(const struct device *dev, 
+    struct led_drivers_stats *stats)
+{
+    const struct led_drivers_api *api = (const struct led_drivers_api *)dev->api;
+    return api->get_stats(dev, stats);
+}
+
 
 #include <syscalls/led_drivers.h>
 
@@ -18,6 +18,10 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
+
+#include <driver/led_drivers/led_drivers.h>
 
 
 // LTC3220 device parameters (DO NOT MODIFY!)
@@ -46,6 +50,7 @@
 #define LTC3220_ULED17                 0x11
 #define LTC3220_ULED18                 0x12
 #define LTC3220_GRAD_BLINK             0x13
+#define LTC3220_REG_CNT                (LTC3220_GRAD_BLINK + 1)
 
 // LTC3220 register masks
 #define LTC3220_COMMAND_QCKWR_MASK     0x01
@@ -53,17 +58,95 @@
 #define LTC3220_COMMAND_SHDWN_MASK     0x08
 #define LTC3220_ULED1_TO_18_LED_MASK   0x3F
 #define LTC3220_ULED1_TO_18_MODE_MASK  0xC0
+#define LTC3220_GRAD_BLINK_UP_MASK     0x01
+#define LTC3220_GRAD_BLINK_GRAD_MASK   0x06
+#define LTC3220_GRAD_BLINK_BLINK_MASK  0x18
+
+// LTC3220 register field values
+#define LTC3220_COMMAND_MODE_AUTO      0x00     // Charge pump switches 1x/1.5x/2x on its own
+#define LTC3220_COMMAND_MODE_1P5X      0x02
+#define LTC3220_COMMAND_MODE_2X        0x04
+#define LTC3220_COMMAND_MODE_1X        0x06
+#define LTC3220_ULED_MODE_NORMAL       0x00
+#define LTC3220_ULED_MODE_BLINK        0x40
+#define LTC3220_ULED_MODE_GRAD         0x80
+#define LTC3220_ULED_MODE_GPO          0xC0
+#define LTC3220_GRAD_BLINK_GRAD_SHIFT  1
+#define LTC3220_GRAD_BLINK_BLINK_SHIFT 3
+
+
+// LED on percentage (0 to 100) to LED level (0 to LTC3220_MAX_LED_LVL - 1), one macro 
+// per brightness curve. Integer only so that every use with a constant folds at compile 
+// time. Non-zero percentages never map to level 0 (LED off)
+#define LTC3220_LVL_MAX                (LTC3220_MAX_LED_LVL - 1)
+#define LTC3220_LVL_NONZERO(per, lvl)  (((per) == 0) ? 0 : MAX(1, (lvl)))
+// Linear in LED current
+#define LTC3220_LVL_LINEAR(per)        (((per) * LTC3220_LVL_MAX) / 100)
+// Gamma 2.0, current follows the square of the percentage
+#define LTC3220_LVL_GAMMA2(per)        LTC3220_LVL_NONZERO(per, \
+   ((per) * (per) * LTC3220_LVL_MAX + 5000) / 10000)
+// CIE 1931 lightness, the percentage is L*: Y = L* / 903.3 up to L* = 8, 
+// ((L* + 16) / 116)^3 above
+#define LTC3220_LVL_CIE1931(per)       LTC3220_LVL_NONZERO(per, ((per) <= 8) ? \
+   (((per) * LTC3220_LVL_MAX * 10 + 4516) / 9033) : \
+   (((per) + 16) * ((per) + 16) * ((per) + 16) * LTC3220_LVL_MAX + 780448) / 1560896)
+
+#if CONFIG_LTC3220_LVL_CURVE_CIE1931
+#define LTC3220_PERCENT_TO_LVL(per)    LTC3220_LVL_CIE1931(per)
+#elif CONFIG_LTC3220_LVL_CURVE_GAMMA2
+#define LTC3220_PERCENT_TO_LVL(per)    LTC3220_LVL_GAMMA2(per)
+#else
+#define LTC3220_PERCENT_TO_LVL(per)    LTC3220_LVL_LINEAR(per)
+#endif
 
+// I2C bytes sent on top of the register data by a write: slave and register address
+#define LTC3220_I2C_WRITE_OVERHEAD     2
+
+
+#if CONFIG_LTC3220_ASYNC
+struct ltc3220_xfer {
+   struct i2c_msg msg;
+   uint32_t mask;                      // Registers written, bit per register
+   uint8_t buf[1 + LTC3220_REG_CNT];   // Register address then data
+};
+
+struct ltc3220_async {
+   struct k_spinlock lock;
+   struct ltc3220_xfer queue[CONFIG_LTC3220_ASYNC_QUEUE_DEPTH];
+   uint8_t head;                       // Oldest queued transfer, the one on the bus
+   uint8_t count;
+   bool enabled;
+   led_drivers_async_cb_t cb;
+   void *user_data;
+   atomic_t invalid;                   // Registers of failed writes, cleared from shadow
+   struct k_sem idle;                  // Given when the queue drains
+   uint32_t errors;
+   uint32_t dropped;
+};
+#endif
 
 struct ltc3220_config
 {
    struct gpio_dt_spec nrst_gpio;
    int32_t led_count;
+   uint32_t led_vf_mv;                 // Highest LED forward voltage at full current
+   uint32_t cp_headroom_mv;            // Current source dropout at full current
 };
 
 struct ltc3220_data {
    const struct device *dev;
    const struct i2c_dt_spec i2c;
+   struct k_mutex lock;
+   uint8_t shadow[LTC3220_REG_CNT];    // Last value written to each register
+   uint32_t shadow_valid;              // Bit per register, set while the shadow is valid
+   uint32_t i2c_xfers;
+   uint32_t i2c_bytes;
+   uint32_t i2c_bytes_saved;
+   uint32_t supply_mv;                 // LED supply (battery) voltage, 0 if unknown
+   bool suspended;
+#if CONFIG_LTC3220_ASYNC
+   struct ltc3220_async async;
+#endif
 };
 
 
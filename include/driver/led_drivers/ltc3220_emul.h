@@ -0,0 +1,63 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       ltc3220_emul.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      I2C emulator for LTC3220 LED drivers. Lets the LTC3220 driver, and what is
+ *             built on it, run on boards without the device (e.g., native_posix) with the
+ *             node placed under a zephyr,i2c-emul-controller bus.
+ */
+
+#ifndef ZEPHYR_DRIVER_LTC3220_EMUL_H_
+#define ZEPHYR_DRIVER_LTC3220_EMUL_H_
+
+#include <zephyr/types.h>
+#include <zephyr/drivers/emul.h>
+
+#include <driver/led_drivers/ltc3220.h>
+
+
+struct ltc3220_emul_traffic {
+   uint32_t xfers;                  // I2C write transactions acknowledged
+   uint32_t bytes;                  // I2C bytes received, including addresses
+   uint32_t nacks;                  // Transactions refused (reads, invalid register)
+};
+
+
+/**
+ * @brief Gets the emulated register file.
+ *
+ * @param[in] target LTC3220 emulator.
+ * @param[out] regs Register values, indexed by register address.
+ */
+void ltc3220_emul_get_regs(const struct emul *target, uint8_t regs[LTC3220_REG_CNT]);
+
+/**
+ * @brief Gets the bus traffic the emulator received since the last clear.
+ *
+ * @param[in] target LTC3220 emulator.
+ * @param[out] traffic Bus traffic counters.
+ */
+void ltc3220_emul_get_traffic(const struct emul *target, struct ltc3220_emul_traffic *traffic);
+
+/**
+ * @brief Clears the bus traffic counters.
+ *
+ * @param[in] target LTC3220 emulator.
+ */
+void ltc3220_emul_clear_traffic(const struct emul *target);
+
+/**
+ * @brief Puts the registers back to their reset value (0), as a low pulse on NRST would.
+ *        The NRST pin itself is not emulated.
+ *
+ * @param[in] target LTC3220 emulator.
+ */
+void ltc3220_emul_reset(const struct emul *target);
+
+
+#endif /* ZEPHYR_DRIVER_LTC3220_EMUL_H_ */
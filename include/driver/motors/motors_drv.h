@@ -17,6 +17,15 @@
 #include <zephyr/toolchain.h>
 #include <zephyr/kernel.h>
 
+#include <errno.h>
+
+
+#define MOTORS_DRV_DUTY_PERMILLE_MAX   1000
+
+// PWM pulse width for a duty cycle in permille (integer only, no FPU on the hot path)
+#define MOTORS_DRV_DC_PULSE(period, duty_pm)                                  \
+   ((uint32_t)(((uint64_t)(period) * (duty_pm)) / MOTORS_DRV_DUTY_PERMILLE_MAX))
+
 
 enum MOTOR_DIRECTION {
    MOTOR_DIR_FORWARD = 0,
@@ -25,14 +34,127 @@ enum MOTOR_DIRECTION {
 };
 
 
-typedef int (*motors_drv_set_dc_pwm_t)(const struct device *dev, float duty_cycle);
+struct motors_drv_profile {
+   uint32_t max_vel;    // Max (cruise) velocity in steps/s
+   uint32_t accel;      // Max acceleration in steps/s^2
+   uint32_t jerk;       // Jerk in steps/s^3, 0 for a trapezoidal profile
+};
+
+enum MOTORS_DRV_SEG_TYPE {
+   MOTORS_DRV_SEG_STEP = 0,         // Stepper move at the 'step-period-us' rate
+   MOTORS_DRV_SEG_STEP_PROFILE,     // Stepper move following the active motion profile
+   MOTORS_DRV_SEG_DC,               // DC motor direction and duty cycle change
+};
+
+// Segment is expected to be followed by another one; finishing it with an empty queue
+// is counted as an underrun
+#define MOTORS_DRV_SEG_F_CHAIN      BIT(0)
+
+struct motors_drv_segment;
+
+typedef void (*motors_drv_seg_cb_t)(const struct device *dev, 
+    const struct motors_drv_segment *seg, int32_t result);
+
+struct motors_drv_segment {
+   uint8_t type;                    // See enum MOTORS_DRV_SEG_TYPE
+   uint8_t dir;                     // See enum MOTOR_DIRECTION
+   uint8_t flags;                   // MOTORS_DRV_SEG_F_*
+   uint8_t duty_cycle_per;          // DC: PWM duty cycle percentage from 0 to 100
+   uint32_t n_steps;                // STEP: total number of steps to complete
+   uint32_t hold_ms;                // DC: time to hold the duty cycle before completing
+   struct k_poll_signal *signal;    // Raised with the result on completion (optional)
+   motors_drv_seg_cb_t cb;          // Called from ISR context on completion (optional)
+   void *user_data;
+};
+
+struct motors_drv_queue_stats {
+   uint32_t depth;                  // Segments waiting in the queue
+   uint32_t depth_max;              // Highest queue depth seen
+   uint32_t completed;              // Segments completed (including failed/flushed)
+   uint32_t underruns;              // Chained segments that found the queue empty
+   bool active;                     // A segment is running
+};
+
+enum MOTORS_DRV_PWR_STATE {
+   MOTORS_DRV_PWR_OFF = 0,          // Drivers asleep, boost converter off
+   MOTORS_DRV_PWR_WAKING,           // Powered, waiting 'pwr-settle-us' before stepping
+   MOTORS_DRV_PWR_ON,               // Powered and in use
+   MOTORS_DRV_PWR_IDLE,             // Powered, unused, sleeps after 'pwr-idle-timeout-ms'
+};
+
+struct motors_drv_pwr_stats {
+   uint8_t state;                   // See enum MOTORS_DRV_PWR_STATE
+   uint8_t users;                   // Bit 0: DC motor, bit 1: stepper motor
+   uint32_t wake_cnt;               // Number of wake-ups from MOTORS_DRV_PWR_OFF
+   int64_t on_ms;                   // Total time powered
+   int64_t uptime_ms;               // Uptime when the stats were taken
+};
+
+// STEP period error histogram: bin 0 counts |error| < 64 ns, bin i counts |error| in 
+// [64 << (i - 1), 64 << i) ns and the last bin everything above
+#define MOTORS_DRV_STEP_HIST_LEN    16
+#define MOTORS_DRV_STEP_HIST_SHIFT  6
+
+struct motors_drv_step_stats {
+   uint32_t periods;                // STEP periods measured
+   int32_t err_min_ns;              // Most negative period error (period too short)
+   int32_t err_max_ns;              // Most positive period error (period too long)
+   int32_t err_mean_ns;
+   uint32_t hist[MOTORS_DRV_STEP_HIST_LEN];
+};
+
+struct motors_drv_sense_stats {
+   uint32_t batches;                // Sample batches processed
+   uint32_t mean_ma;                // Mean supply current of the last batch
+   uint32_t max_ma;                 // Highest supply current of the last batch
+   uint32_t peak_ma;                // Highest supply current seen
+   uint32_t stalls;                 // Stepper moves aborted (or homed) on a current stall
+   uint32_t overcurrents;           // DC motor stops on over-current
+   uint32_t abort_us_max;           // Worst case first over-limit batch to abort time
+};
+
+
+typedef int (*motors_drv_set_dc_pwm_t)(const struct device *dev, const uint16_t duty_permille);
 typedef int (*motors_drv_move_dc_t)(const struct device *dev, const uint8_t dir, const uint8_t duty_cycle_per);
+typedef int (*motors_drv_move_dc_immediate_t)(const struct device *dev, const uint8_t dir, 
+    const uint8_t duty_cycle_per);
 typedef int (*motors_drv_move_step_t)(const struct device *dev, const uint8_t dir, const uint32_t n_steps);
+typedef int (*motors_drv_move_step_profile_t)(const struct device *dev, const uint8_t dir, 
+    const uint32_t n_steps, const struct motors_drv_profile *profile);
+typedef int (*motors_drv_queue_t)(const struct device *dev, const struct motors_drv_segment *seg);
+typedef int (*motors_drv_flush_t)(const struct device *dev);
+typedef int (*motors_drv_get_queue_stats_t)(const struct device *dev, 
+    struct motors_drv_queue_stats *stats);
+typedef int (*motors_drv_move_to_t)(const struct device *dev, const int32_t position);
+typedef int (*motors_drv_get_position_t)(const struct device *dev, int32_t *position);
+typedef int (*motors_drv_home_t)(const struct device *dev);
+typedef int (*motors_drv_drive_t)(const struct device *dev, const int16_t throttle_permille, 
+    const int32_t steering_pos);
+typedef int (*motors_drv_stop_t)(const struct device *dev);
+typedef int (*motors_drv_get_pwr_stats_t)(const struct device *dev, 
+    struct motors_drv_pwr_stats *stats);
+typedef int (*motors_drv_get_step_stats_t)(const struct device *dev, 
+    struct motors_drv_step_stats *stats, const bool reset);
+typedef int (*motors_drv_get_sense_stats_t)(const struct device *dev, 
+    struct motors_drv_sense_stats *stats);
 
 __subsystem struct motors_drv_api {
-   motors_drv_set_dc_pwm_t  set_dc_pwm;
-   motors_drv_move_dc_t     move_dc;
-   motors_drv_move_step_t   move_step;
+   motors_drv_set_dc_pwm_t          set_dc_pwm;
+   motors_drv_move_dc_t             move_dc;
+   motors_drv_move_dc_immediate_t   move_dc_immediate;
+   motors_drv_move_step_t           move_step;
+   motors_drv_move_step_profile_t   move_step_profile;
+   motors_drv_queue_t               queue;
+   motors_drv_flush_t               flush;
+   motors_drv_get_queue_stats_t     get_queue_stats;
+   motors_drv_move_to_t             move_to;
+   motors_drv_get_position_t        get_position;
+   motors_drv_home_t                home;
+   motors_drv_drive_t               drive;
+   motors_drv_stop_t                stop;
+   motors_drv_get_pwr_stats_t       get_pwr_stats;
+   motors_drv_get_sense_stats_t     get_sense_stats;
+   motors_drv_get_step_stats_t      get_step_stats;
 };
 
 
@@ -40,22 +162,45 @@ __subsystem struct motors_drv_api {
  * @brief Sets the PWM duty cycle for the DC motor.
  *
  * @param[in] dev Motors driver device instance.
- * @param[in] duty_cycle PWM duty cycle from 0.0 to 1.0.
+ * @param[in] duty_permille PWM duty cycle from 0 to MOTORS_DRV_DUTY_PERMILLE_MAX.
  *
  * @retval 0 on success.
  * @retval Error code on failure.
  */
-__syscall int motors_drv_set_dc_pwm(const struct device *dev, float duty_cycle);
+__syscall int motors_drv_set_dc_pwm_permille(const struct device *dev, 
+    const uint16_t duty_permille);
 
-static inline int z_impl_motors_drv_set_dc_pwm(const struct device *dev, float duty_cycle)
+static inline int z_impl_motors_drv_set_dc_pwm_permille(const struct device *dev, 
+    const uint16_t duty_permille)
 {
     const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
-    return api->set_dc_pwm(dev, duty_cycle);
+    return api->set_dc_pwm(dev, duty_permille);
+}
+
+/**
+ * @brief Sets the PWM duty cycle for the DC motor. Kept for existing callers, prefer 
+ *        motors_drv_set_dc_pwm_permille() which does not use the FPU.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] duty_cycle PWM duty cycle from 0.0 to 1.0.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+static inline int motors_drv_set_dc_pwm(const struct device *dev, float duty_cycle)
+{
+    if ((duty_cycle < 0.0f) || (duty_cycle > 1.0f)) {
+        return -EINVAL;
+    }
+    return motors_drv_set_dc_pwm_permille(dev, 
+        (uint16_t)((duty_cycle * MOTORS_DRV_DUTY_PERMILLE_MAX) + 0.5f));
 }
 
 /**
  * @brief Moves the DC motor with specified direction and PWM percentage. Note that the 
- *        period of the DC motor PWM is set in 'motors0' in the device tree.
+ *        period of the DC motor PWM is set in 'motors0' in the device tree. The duty 
+ *        cycle ramps to the new value at the 'dc-accel-slew' / 'dc-brake-slew' rates, 
+ *        passing through zero when reversing. Returns without waiting for the ramp.
  *
  * @param[in] dev Motors driver device instance.
  * @param[in] dir Direction of the DC motor (see enum MOTOR_DIRECTION).
@@ -72,9 +217,31 @@ static inline int z_impl_motors_drv_move_dc(const struct device *dev, const uint
     return api->move_dc(dev, dir, duty_cycle_per);
 }
 
+/**
+ * @brief Moves the DC motor with specified direction and PWM percentage right away, 
+ *        cancelling any ramp in progress. Meant for emergency stops.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] dir Direction of the DC motor (see enum MOTOR_DIRECTION).
+ * @param[in] duty_cycle_per PWM duty cycle percentage from 0 to 100.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_move_dc_immediate(const struct device *dev, const uint8_t dir, 
+    const uint8_t duty_cycle_per);
+
+static inline int z_impl_motors_drv_move_dc_immediate(const struct device *dev, 
+    const uint8_t dir, const uint8_t duty_cycle_per)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->move_dc_immediate(dev, dir, duty_cycle_per);
+}
+
 /**
  * @brief Moves the stepper motor with specified direction and total steps. Note that the 
- *        period of the stepper motor delay is set in 'motors0' in the device tree.
+ *        period of the stepper motor delay is set in 'motors0' in the device tree. The 
+ *        move is queued behind any segments already queued (see motors_drv_queue()).
  *
  * @param[in] dev Motors driver device instance.
  * @param[in] dir Direction of the stepper motor (see enum MOTOR_DIRECTION).
@@ -91,6 +258,259 @@ static inline int z_impl_motors_drv_move_step(const struct device *dev, const ui
     return api->move_step(dev, dir, n_steps);
 }
 
+/**
+ * @brief Moves the stepper motor with specified direction and total steps following a 
+ *        motion profile. The stepper starts and stops at the 'step-period-us' rate set in 
+ *        the device tree, accelerates up to the profile max velocity and decelerates 
+ *        symmetrically. The ramp table is computed ahead of the move and cached, so 
+ *        repeated moves with the same profile do not recompute it. The move is queued 
+ *        behind any segments already queued (see motors_drv_queue()).
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] dir Direction of the stepper motor (see enum MOTOR_DIRECTION).
+ * @param[in] n_steps Total number of steps to complete.
+ * @param[in] profile Motion profile, or NULL for the device tree default profile.
+ *
+ * @retval 0 on success.
+ * @retval -EBUSY if the profile differs from the one used by queued segments.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_move_step_profile(const struct device *dev, const uint8_t dir, 
+    const uint32_t n_steps, const struct motors_drv_profile *profile);
+
+static inline int z_impl_motors_drv_move_step_profile(const struct device *dev, 
+    const uint8_t dir, const uint32_t n_steps, const struct motors_drv_profile *profile)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->move_step_profile(dev, dir, n_steps, profile);
+}
+
+/**
+ * @brief Queues a motion segment. Queued segments run back to back in order, the next 
+ *        one being started from the completion interrupt of the previous one. Completion 
+ *        of each segment is reported through its signal and/or callback.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] seg Segment to queue (copied).
+ *
+ * @retval 0 on success.
+ * @retval -ENOBUFS if the queue is full.
+ * @retval -ERANGE if the stepper move would end outside the soft limits.
+ * @retval -EBUSY while homing.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_queue(const struct device *dev, const struct motors_drv_segment *seg);
+
+static inline int z_impl_motors_drv_queue(const struct device *dev, 
+    const struct motors_drv_segment *seg)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->queue(dev, seg);
+}
+
+/**
+ * @brief Stops the running segment and drops all queued segments. Each of them completes 
+ *        with -ECANCELED.
+ *
+ * @param[in] dev Motors driver device instance.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_flush(const struct device *dev);
+
+static inline int z_impl_motors_drv_flush(const struct device *dev)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->flush(dev);
+}
+
+/**
+ * @brief Gets the motion segment queue statistics.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[out] stats Queue statistics.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_get_queue_stats(const struct device *dev, 
+    struct motors_drv_queue_stats *stats);
+
+static inline int z_impl_motors_drv_get_queue_stats(const struct device *dev, 
+    struct motors_drv_queue_stats *stats)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->get_queue_stats(dev, stats);
+}
+
+/**
+ * @brief Moves the stepper motor to an absolute position following the active motion 
+ *        profile. The move is relative to the position reached once every queued 
+ *        segment is done.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] position Target position in steps.
+ *
+ * @retval 0 on success.
+ * @retval -ERANGE if the position is outside the soft limits.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_move_to(const struct device *dev, const int32_t position);
+
+static inline int z_impl_motors_drv_move_to(const struct device *dev, const int32_t position)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->move_to(dev, position);
+}
+
+/**
+ * @brief Gets the absolute stepper position, updated at step granularity while moving.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[out] position Current position in steps.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_get_position(const struct device *dev, int32_t *position);
+
+static inline int z_impl_motors_drv_get_position(const struct device *dev, int32_t *position)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->get_position(dev, position);
+}
+
+/**
+ * @brief Homes the stepper motor. Queued segments are flushed, then the stepper is 
+ *        driven backward by 'step-home-steps' against its mechanical end stop and the 
+ *        position is set to 'step-home-pos'. Completion can be followed with 
+ *        motors_drv_get_queue_stats().
+ *
+ * @param[in] dev Motors driver device instance.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if homing is not configured.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_home(const struct device *dev);
+
+static inline int z_impl_motors_drv_home(const struct device *dev)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->home(dev);
+}
+
+/**
+ * @brief Sets the DC motor throttle and the stepper steering position together, for 
+ *        one joystick update. Both are validated before either is applied, and both 
+ *        are applied without another thread running in between. The throttle ramps 
+ *        like motors_drv_move_dc(). Queued segments not yet started are dropped so 
+ *        steering goes to the latest target right after the running move.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[in] throttle_permille Signed DC duty cycle, positive is forward, from 
+ *            -MOTORS_DRV_DUTY_PERMILLE_MAX to MOTORS_DRV_DUTY_PERMILLE_MAX.
+ * @param[in] steering_pos Absolute stepper position in steps.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if the throttle is out of range.
+ * @retval -ERANGE if the steering position is outside the soft limits.
+ * @retval -EBUSY while homing, nothing is applied.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_drive(const struct device *dev, const int16_t throttle_permille, 
+    const int32_t steering_pos);
+
+static inline int z_impl_motors_drv_drive(const struct device *dev, 
+    const int16_t throttle_permille, const int32_t steering_pos)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->drive(dev, throttle_permille, steering_pos);
+}
+
+/**
+ * @brief Stops both motors right away: the running segment and every queued one are 
+ *        cancelled (-ECANCELED), the stepper stays where it stopped and the DC motor 
+ *        stops without ramping. Safe to call from ISR context, e.g. from a failsafe.
+ *
+ * @param[in] dev Motors driver device instance.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_stop(const struct device *dev);
+
+static inline int z_impl_motors_drv_stop(const struct device *dev)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->stop(dev);
+}
+
+/**
+ * @brief Gets the motors supply (nSLEEP and boost EN) power statistics. The supply is 
+ *        shared by the DC and stepper motors and stays on for 'pwr-idle-timeout-ms' 
+ *        after the last of them stops.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[out] stats Power statistics.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+__syscall int motors_drv_get_pwr_stats(const struct device *dev, 
+    struct motors_drv_pwr_stats *stats);
+
+static inline int z_impl_motors_drv_get_pwr_stats(const struct device *dev, 
+    struct motors_drv_pwr_stats *stats)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->get_pwr_stats(dev, stats);
+}
+
+/**
+ * @brief Gets the motors supply current sensing statistics. A stepper move that draws 
+ *        more than 'sense-step-max-ma' is aborted with -EIO (a homing move completes 
+ *        instead, it ran into the end stop) and the DC motor is stopped when it draws 
+ *        more than 'sense-dc-max-ma'.
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[out] stats Current sensing statistics.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if current sensing is not enabled.
+ */
+__syscall int motors_drv_get_sense_stats(const struct device *dev, 
+    struct motors_drv_sense_stats *stats);
+
+static inline int z_impl_motors_drv_get_sense_stats(const struct device *dev, 
+    struct motors_drv_sense_stats *stats)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->get_sense_stats(dev, stats);
+}
+
+/**
+ * @brief Gets the STEP timing statistics: the error of every STEP period against the 
+ *        period it was meant to have ('step-period-us' or the motion profile ramp).
+ *
+ * @param[in] dev Motors driver device instance.
+ * @param[out] stats STEP timing statistics.
+ * @param[in] reset Clear the statistics once read.
+ *
+ * @retval 0 on success.
+ * @retval -ENOTSUP if CONFIG_MOTORS_DRV_STATS is not enabled.
+ */
+__syscall int motors_drv_get_step_stats(const struct device *dev, 
+    struct motors_drv_step_stats *stats, const bool reset);
+
+static inline int z_impl_motors_drv_get_step_stats(const struct device *dev, 
+    struct motors_drv_step_stats *stats, const bool reset)
+{
+    const struct motors_drv_api *api = (const struct motors_drv_api *)dev->api;
+    return api->get_step_stats(dev, stats, reset);
+}
+
 
 #include <syscalls/motors_drv.h>
 
@@ -0,0 +1,40 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_profile.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Stepper motion profile (ramp table) generation for the motors driver.
+ */
+
+#ifndef ZEPHYR_DRIVER_MOTORS_PROFILE_H_
+#define ZEPHYR_DRIVER_MOTORS_PROFILE_H_
+
+#include <zephyr/types.h>
+
+#include <driver/motors/motors_drv.h>
+
+
+/**
+ * @brief Builds the acceleration ramp table of STEP periods for a motion profile using
+ *        integer math only. The ramp starts at v_start and ends once the profile max
+ *        velocity is reached (or the table is full). Deceleration uses the same table in
+ *        reverse. Must not be called from ISR context.
+ *
+ * @param[in] profile Motion profile (jerk of 0 gives a trapezoidal profile).
+ * @param[in] v_start Start/stop velocity in steps/s.
+ * @param[out] ramp_us Ramp table of STEP periods in microseconds.
+ * @param[in] max_len Maximum number of entries in the ramp table.
+ * @param[out] cruise_us STEP period in microseconds at the end of the ramp.
+ *
+ * @retval Number of entries written to the ramp table on success.
+ * @retval Negative error code on failure.
+ */
+int32_t motors_profile_build(const struct motors_drv_profile *profile, uint32_t v_start,
+   uint32_t *ramp_us, uint32_t max_len, uint32_t *cruise_us);
+
+
+#endif /* ZEPHYR_DRIVER_MOTORS_PROFILE_H_ */
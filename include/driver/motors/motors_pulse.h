@@ -0,0 +1,217 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_pulse.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      STEP pulse engine used by the motors driver. The pulse train is generated
+ *             either by hardware (TIMER + GPIOTE + PPI) or by a k_timer for targets
+ *             such as native_posix.
+ *
+ *             Drivers step on the STEP rising edge, only the period is guaranteed. The
+ *             high time is engine specific: a fixed 2 us pulse for the hardware engine,
+ *             half the period (50% duty cycle) for the k_timer engine.
+ */
+
+#ifndef ZEPHYR_DRIVER_MOTORS_PULSE_H_
+#define ZEPHYR_DRIVER_MOTORS_PULSE_H_
+
+#include <zephyr/device.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+#if CONFIG_MOTORS_DRV_STATS
+#include <string.h>
+#include <zephyr/sys/math_extras.h>
+#include <zephyr/timing/timing.h>
+#include <driver/motors/motors_drv.h>
+#endif
+
+
+/**
+ * @brief Called once when the requested pulse train has been fully sent. Runs in ISR
+ *        context, also for an empty train (never from within motors_pulse_start*()).
+ *
+ * @param[in] dev Motors driver device instance owning the pulse engine.
+ * @param[in] n_pulses Total number of pulses sent.
+ */
+typedef void (*motors_pulse_done_cb_t)(const struct device *dev, uint32_t n_pulses);
+
+struct motors_pulse_cfg {
+   struct gpio_dt_spec step_gpio;
+   uint32_t step_psel;
+};
+
+struct motors_pulse {
+   const struct device *dev;
+   const struct motors_pulse_cfg *cfg;
+   motors_pulse_done_cb_t done_cb;
+   volatile bool busy;
+   volatile uint32_t n_pulses;
+   const uint32_t *ramp_us;
+   uint32_t ramp_len;
+   uint32_t cruise_us;
+   volatile uint32_t idx;
+   volatile uint32_t late_cnt;
+#if CONFIG_MOTORS_DRV_PULSE_NRFX
+   void *hw;
+#endif
+#if CONFIG_MOTORS_DRV_PULSE_SW
+   struct k_timer timer;
+   volatile bool level;
+#endif
+#if CONFIG_MOTORS_DRV_STATS
+   struct motors_drv_step_stats stats;
+   int64_t stats_err_sum_ns;
+   uint32_t stats_train_cnt;        // Periods measured in the running pulse train
+#if CONFIG_MOTORS_DRV_PULSE_SW
+   timing_t stats_last_edge;
+#endif
+#endif
+};
+
+
+/**
+ * @brief Gets the STEP period of the given pulse of a pulse train. The first ramp_len
+ *        pulses follow the ramp table, the last ramp_len pulses follow it in reverse and
+ *        everything in between runs at the cruise period.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[in] idx Index of the pulse within the pulse train.
+ *
+ * @retval STEP period in microseconds.
+ */
+static inline uint32_t motors_pulse_period_us(const struct motors_pulse *pulse, uint32_t idx)
+{
+   if (idx < pulse->ramp_len) {
+      return pulse->ramp_us[idx];
+   }
+   if (idx >= (pulse->n_pulses - pulse->ramp_len)) {
+      return pulse->ramp_us[pulse->n_pulses - 1 - idx];
+   }
+   return pulse->cruise_us;
+}
+
+
+#if CONFIG_MOTORS_DRV_STATS
+/**
+ * @brief Adds one STEP period error to the timing statistics. Called by the pulse 
+ *        engines from ISR context, kept short enough to leave enabled.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[in] err_ns Measured minus expected STEP period in nanoseconds.
+ */
+static inline void motors_pulse_stats_add(struct motors_pulse *pulse, int32_t err_ns)
+{
+   struct motors_drv_step_stats *stats = &pulse->stats;
+   uint32_t mag = ((err_ns < 0) ? -err_ns : err_ns) >> MOTORS_DRV_STEP_HIST_SHIFT;
+   uint32_t bin = (mag == 0) ? 0 : (32 - u32_count_leading_zeros(mag));
+
+   if (stats->periods == 0)
+   {
+      stats->err_min_ns = err_ns;
+      stats->err_max_ns = err_ns;
+   }
+   stats->err_min_ns = MIN(stats->err_min_ns, err_ns);
+   stats->err_max_ns = MAX(stats->err_max_ns, err_ns);
+   stats->hist[MIN(bin, MOTORS_DRV_STEP_HIST_LEN - 1)]++;
+   stats->periods++;
+   pulse->stats_err_sum_ns += err_ns;
+   pulse->stats_train_cnt++;
+}
+
+/**
+ * @brief Copies the STEP timing statistics out of the pulse engine.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[out] stats STEP timing statistics.
+ * @param[in] reset Clear the statistics once read.
+ */
+static inline void motors_pulse_get_stats(struct motors_pulse *pulse, 
+   struct motors_drv_step_stats *stats, bool reset)
+{
+   unsigned int key = irq_lock();
+
+   *stats = pulse->stats;
+   stats->err_mean_ns = (stats->periods > 0) ? 
+      (int32_t)(pulse->stats_err_sum_ns / stats->periods) : 0;
+   if (reset)
+   {
+      memset(&pulse->stats, 0, sizeof(pulse->stats));
+      pulse->stats_err_sum_ns = 0;
+   }
+   irq_unlock(key);
+}
+#endif
+
+
+/**
+ * @brief Initializes the pulse engine. The STEP GPIO must already be configured as an
+ *        output driven low.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[in] dev Motors driver device instance passed back in the done callback.
+ * @param[in] cfg STEP signal configuration.
+ * @param[in] done_cb Callback raised once per completed pulse train.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t motors_pulse_init(struct motors_pulse *pulse, const struct device *dev,
+   const struct motors_pulse_cfg *cfg, motors_pulse_done_cb_t done_cb);
+
+/**
+ * @brief Starts a pulse train of n_pulses STEP pulses with the given period. Any train
+ *        already running is stopped first.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[in] n_pulses Total number of pulses to send.
+ * @param[in] period_us STEP period in microseconds.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t motors_pulse_start(struct motors_pulse *pulse, uint32_t n_pulses, uint32_t period_us);
+
+/**
+ * @brief Starts a pulse train of n_pulses STEP pulses that accelerates through the ramp
+ *        table, cruises and then decelerates through the ramp table in reverse. The ramp
+ *        is shortened to n_pulses / 2 for short moves. The ramp table must stay valid
+ *        until the pulse train is done or stopped.
+ *
+ * @param[in] pulse Pulse engine instance.
+ * @param[in] n_pulses Total number of pulses to send.
+ * @param[in] ramp_us Acceleration ramp table of STEP periods in microseconds.
+ * @param[in] ramp_len Number of entries in the ramp table.
+ * @param[in] cruise_us STEP period in microseconds between the ramps.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t motors_pulse_start_ramp(struct motors_pulse *pulse, uint32_t n_pulses,
+   const uint32_t *ramp_us, uint32_t ramp_len, uint32_t cruise_us);
+
+/**
+ * @brief Stops the running pulse train (if any) and leaves STEP low. The done callback
+ *        is not raised.
+ *
+ * @param[in] pulse Pulse engine instance.
+ *
+ * @retval Number of pulses sent before the train was stopped.
+ */
+uint32_t motors_pulse_stop(struct motors_pulse *pulse);
+
+/**
+ * @brief Gets the number of pulses sent so far by the running (or last) pulse train.
+ *
+ * @param[in] pulse Pulse engine instance.
+ *
+ * @retval Number of completed pulses.
+ */
+uint32_t motors_pulse_get_count(struct motors_pulse *pulse);
+
+
+#endif /* ZEPHYR_DRIVER_MOTORS_PULSE_H_ */
@@ -0,0 +1,88 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_sense.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Motors supply current sensing used by the motors driver. The SAADC samples
+ *             the current sense input continuously into two DMA buffers and every full
+ *             buffer is reduced to one filtered batch result.
+ */
+
+#ifndef ZEPHYR_DRIVER_MOTORS_SENSE_H_
+#define ZEPHYR_DRIVER_MOTORS_SENSE_H_
+
+#include <zephyr/device.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/kernel.h>
+
+
+// 'sense-ain' value when no current sense input is wired
+#define MOTORS_SENSE_AIN_NONE    0xFF
+
+
+/**
+ * @brief Called once per batch of CONFIG_MOTORS_DRV_SENSE_BATCH samples. Runs in ISR
+ *        context.
+ *
+ * @param[in] dev Motors driver device instance owning the sense channel.
+ * @param[in] mean_ma Mean motors supply current of the batch in mA.
+ * @param[in] max_ma Highest motors supply current of the batch in mA.
+ */
+typedef void (*motors_sense_batch_cb_t)(const struct device *dev, uint32_t mean_ma,
+   uint32_t max_ma);
+
+struct motors_sense_cfg {
+   uint8_t ain;                     // SAADC analog input (AINx), or MOTORS_SENSE_AIN_NONE
+   uint32_t mv_per_a;               // Sense transresistance in mV/A (shunt times gain)
+};
+
+struct motors_sense {
+   const struct device *dev;
+   const struct motors_sense_cfg *cfg;
+   motors_sense_batch_cb_t batch_cb;
+   int16_t buf[2][CONFIG_MOTORS_DRV_SENSE_BATCH];
+   uint8_t buf_next;
+   volatile uint32_t batch_cnt;
+};
+
+
+/**
+ * @brief Initializes the SAADC for continuous sampling of the sense input. Sampling
+ *        only runs between motors_sense_start() and motors_sense_stop().
+ *
+ * @param[in] sense Sense channel instance.
+ * @param[in] dev Motors driver device instance passed back in the batch callback.
+ * @param[in] cfg Sense input configuration.
+ * @param[in] batch_cb Callback raised once per batch.
+ *
+ * @retval 0 on success.
+ * @retval -EBUSY if the SAADC is already used by another motors instance.
+ * @retval Error code on failure.
+ */
+int32_t motors_sense_init(struct motors_sense *sense, const struct device *dev,
+   const struct motors_sense_cfg *cfg, motors_sense_batch_cb_t batch_cb);
+
+/**
+ * @brief Starts continuous sampling at CONFIG_MOTORS_DRV_SENSE_RATE_HZ. Does nothing if
+ *        already running. ISR safe.
+ *
+ * @param[in] sense Sense channel instance.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t motors_sense_start(struct motors_sense *sense);
+
+/**
+ * @brief Stops sampling, the batch in progress is dropped. ISR safe.
+ *
+ * @param[in] sense Sense channel instance.
+ */
+void motors_sense_stop(struct motors_sense *sense);
+
+
+#endif /* ZEPHYR_DRIVER_MOTORS_SENSE_H_ */
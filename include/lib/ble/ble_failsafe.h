@@ -0,0 +1,71 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       ble_failsafe.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      BLE link-loss failsafe. Calls a handler (e.g., to stop the motors) when the
+ *             central disconnects or stops sending commands.
+ */
+
+#ifndef BLE_FAILSAFE_H_
+#define BLE_FAILSAFE_H_
+
+#include <zephyr/types.h>
+
+
+typedef enum {
+   BLE_FAILSAFE_DISCONNECT = 0,     // Central disconnected (or link supervision timeout)
+   BLE_FAILSAFE_KEEPALIVE,          // No command received within the keepalive timeout
+   BLE_FAILSAFE_REASON_CNT,
+} ble_failsafe_reason_t;
+
+/**
+ * @brief Failsafe handler. Runs in ISR context (system timer) so it cannot be held off
+ *        by the shell, logging or any other thread; it must not block.
+ *
+ * @param[in] reason Why the failsafe tripped.
+ */
+typedef void (*ble_failsafe_handler_t)(ble_failsafe_reason_t reason);
+
+struct ble_failsafe_stats {
+   uint32_t trips[BLE_FAILSAFE_REASON_CNT];
+   uint32_t latency_us_last;        // Trip deadline to handler return, last trip
+   uint32_t latency_us_max;         // Trip deadline to handler return, worst case
+   uint32_t keepalive_ms;           // Keepalive timeout, 0 if disabled
+};
+
+
+/**
+ * @brief Sets the failsafe handler. Only one handler is supported.
+ *
+ * @param[in] handler Handler called when the failsafe trips, NULL to remove it.
+ */
+void ble_failsafe_set_handler(ble_failsafe_handler_t handler);
+
+/**
+ * @brief Feeds the command keepalive. Called for every command received over BLE. The
+ *        failsafe trips if no command follows within CONFIG_BLE_FAILSAFE_KEEPALIVE_MS.
+ */
+void ble_failsafe_feed(void);
+
+/**
+ * @brief Trips the failsafe right away, e.g., on disconnect. The keepalive is stopped
+ *        until the next ble_failsafe_feed().
+ *
+ * @param[in] reason Why the failsafe tripped.
+ */
+void ble_failsafe_trip(ble_failsafe_reason_t reason);
+
+/**
+ * @brief Gets the failsafe trip counters and stop latencies.
+ *
+ * @param[out] stats Failsafe statistics.
+ */
+void ble_failsafe_get_stats(struct ble_failsafe_stats *stats);
+
+
+#endif /* BLE_FAILSAFE_H_ */
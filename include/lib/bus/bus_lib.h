@@ -0,0 +1,165 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       bus_lib.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Event bus between the vehicle modules, on zbus. Each channel holds the latest
+ *             state of one module; observers run on a dedicated workqueue so that adding
+ *             a behaviour needs no polling and never runs in the publisher's context.
+ *             The same workqueue runs all of the actuation work, away from the system
+ *             workqueue the Bluetooth host shares, and times every work item.
+ */
+
+#ifndef BUS_LIB_H_
+#define BUS_LIB_H_
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+
+
+// Observers only queue work, a channel is never held for long
+#define BUS_LIB_PUB_TIMEOUT            K_MSEC(10)
+
+struct bus_drive_state {
+   int16_t throttle_permille;       // Signed DC duty cycle, positive is forward
+   int32_t steering_pos;            // Stepper position in steps, positive is right
+};
+
+struct bus_link_state {
+   bool connected;                  // Central connected over BLE
+};
+
+struct bus_bat_state {
+   uint8_t status;                  // See enum BAT_CHARGER_STATUS
+   uint32_t voltage_mv;             // Battery voltage, 0 if unknown
+};
+
+struct bus_lights_state {
+   uint32_t scenes;                 // Scenes shown, bits defined by the profile
+};
+
+struct bus_lib_work_stats {
+   uint32_t runs;                   // Times the handler ran
+   uint32_t queue_us_last;          // Time from due to handler start
+   uint32_t queue_us_max;
+   uint32_t exec_us_last;           // Time spent in the handler
+   uint32_t exec_us_max;
+};
+
+// Work item of the bus workqueue, define it with BUS_LIB_WORK_DEFINE()
+struct bus_lib_work {
+   struct k_work_delayable dwork;
+   k_work_handler_t handler;
+   const char *name;
+   int64_t due;                     // Uptime in ticks the item was due to run
+   struct bus_lib_work_stats stats;
+};
+
+ZBUS_CHAN_DECLARE(bus_drive_chan, bus_link_chan, bus_bat_chan, bus_lights_chan);
+
+// Work item running handler (void (*)(struct k_work *)) on the bus workqueue. Items are
+// kept in an iterable section so that their timings can be listed
+#define BUS_LIB_WORK_DEFINE(_name, _handler)                               \
+   STRUCT_SECTION_ITERABLE(bus_lib_work, _name) = {                        \
+      .dwork = Z_WORK_DELAYABLE_INITIALIZER(bus_lib_work_run),             \
+      .handler = _handler,                                                 \
+      .name = #_name,                                                      \
+   }
+
+// Observer running handler (void (*)(struct k_work *)) on the bus workqueue after a
+// publish. Publishes made before it runs are handled by one call, the handler reads the
+// latest state of the channels it needs. Attach it with bus_lib_observe()
+#define BUS_LIB_OBSERVER_DEFINE(_name, _handler)                           \
+   static BUS_LIB_WORK_DEFINE(_name##_work, _handler);                     \
+   static void _name##_notify(const struct zbus_channel *chan)             \
+   {                                                                       \
+      ARG_UNUSED(chan);                                                    \
+      (void)bus_lib_submit(&_name##_work);                                 \
+   }                                                                       \
+   ZBUS_LISTENER_DEFINE(_name, _name##_notify)
+
+// Runs the handler of a bus_lib_work and times it, used by BUS_LIB_WORK_DEFINE()
+void bus_lib_work_run(struct k_work *item);
+
+
+/**
+ * @brief Starts the bus workqueue. Work submitted before it is started is refused.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t bus_lib_init(void);
+
+/**
+ * @brief Attaches an observer to a channel.
+ *
+ * @param[in] chan Channel to observe.
+ * @param[in] obs Observer, see BUS_LIB_OBSERVER_DEFINE().
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t bus_lib_observe(const struct zbus_channel *chan, const struct zbus_observer *obs);
+
+/**
+ * @brief Publishes a new state on a channel. Thread context only, sources running in ISR
+ *        context submit work that publishes (see bus_lib_submit()).
+ *
+ * @param[in] chan Channel to publish on.
+ * @param[in] msg New state, of the channel's message type.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t bus_lib_pub(const struct zbus_channel *chan, const void *msg);
+
+/**
+ * @brief Submits work to the bus workqueue, to run as soon as possible. Work that is
+ *        already queued or scheduled is left as it is. Can be called from ISR context.
+ *
+ * @param[in] work Work item.
+ *
+ * @retval 0 on success (including already queued).
+ * @retval Error code on failure.
+ */
+int32_t bus_lib_submit(struct bus_lib_work *work);
+
+/**
+ * @brief Schedules work on the bus workqueue, replacing any pending schedule. Can be
+ *        called from ISR context.
+ *
+ * @param[in] work Work item.
+ * @param[in] delay Relative delay before the work runs.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t bus_lib_schedule(struct bus_lib_work *work, k_timeout_t delay);
+
+/**
+ * @brief Cancels work that is queued or scheduled. Work already running completes.
+ *
+ * @param[in] work Work item.
+ */
+void bus_lib_cancel(struct bus_lib_work *work);
+
+/**
+ * @brief Gets the timings of a work item.
+ *
+ * @param[in] work Work item.
+ * @param[out] stats Timings since the last reset.
+ */
+void bus_lib_work_get_stats(struct bus_lib_work *work, struct bus_lib_work_stats *stats);
+
+/**
+ * @brief Clears the timings of all work items.
+ */
+void bus_lib_work_reset_stats(void);
+
+
+#endif /* BUS_LIB_H_ */
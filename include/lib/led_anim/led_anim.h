@@ -0,0 +1,145 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       led_anim.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      LED animation engine on top of the LED drivers API. Timelines of keyframes
+ *             play on layers which are composited at a fixed frame rate; only the
+ *             channels that changed since the last frame are written to the device.
+ */
+
+#ifndef LED_ANIM_H_
+#define LED_ANIM_H_
+
+#include <zephyr/types.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/util.h>
+
+
+// Keyframe level leaving the channel to the layers below (transparent)
+#define LED_ANIM_LVL_NONE        0xFF
+
+// Timeline flags
+#define LED_ANIM_F_LOOP          BIT(0)   // Restart from 0 at the end
+#define LED_ANIM_F_HOLD          BIT(1)   // Keep the last levels at the end, else the layer stops
+
+struct led_anim_key {
+   uint16_t t_ms;                   // Time from the timeline start
+   uint8_t lvl;                     // LED level, or LED_ANIM_LVL_NONE
+};
+
+struct led_anim_track {
+   uint8_t channel;                 // LED number on the device
+   uint8_t key_cnt;
+   const struct led_anim_key *keys; // Sorted by time. Levels are interpolated linearly,
+                                    // two keys at the same time make a step
+};
+
+struct led_anim_timeline {
+   const char *name;
+   uint16_t duration_ms;
+   uint8_t flags;
+   uint8_t track_cnt;
+   const struct led_anim_track *tracks;
+};
+
+struct led_anim_change {
+   uint8_t layer;
+   const struct led_anim_timeline *timeline; // Played from its start, NULL stops the layer
+};
+
+struct led_anim_stats {
+   uint32_t frames;                 // Frames composited
+   uint32_t frames_skipped;         // Frames dropped to catch up after running late
+   uint32_t late_us_max;            // Worst frame start delay past its scheduled time
+   uint32_t writes;                 // Device writes (one per run of changed channels)
+   uint32_t channels_written;       // Channels written, including unchanged ones in runs
+};
+
+// Track of one channel from a list of keyframes, e.g.,
+// LED_ANIM_TRACK(3, { 0, 0 }, { 500, 63 }) fades LED 3 in over 500 ms
+#define LED_ANIM_TRACK(_channel, ...)                                      \
+   {                                                                       \
+      .channel = (_channel),                                               \
+      .key_cnt = ARRAY_SIZE(((const struct led_anim_key[]){ __VA_ARGS__ })), \
+      .keys = (const struct led_anim_key[]){ __VA_ARGS__ },                \
+   }
+
+
+/**
+ * @brief Initializes the engine. The compositor thread only wakes up while a layer is
+ *        playing.
+ *
+ * @param[in] dev LED drivers device instance to output to.
+ * @param[in] timelines Timelines that can be found by name, kept by reference.
+ * @param[in] count Number of timelines.
+ *
+ * @retval 0 on success.
+ * @retval Error code on failure.
+ */
+int32_t led_anim_init(const struct device *dev, const struct led_anim_timeline *timelines,
+   size_t count);
+
+/**
+ * @brief Finds a timeline given to led_anim_init() by name.
+ *
+ * @param[in] name Timeline name.
+ *
+ * @retval Timeline, NULL if not found.
+ */
+const struct led_anim_timeline *led_anim_find(const char *name);
+
+/**
+ * @brief Plays a timeline on a layer from its start, replacing what the layer played.
+ *        Higher layers cover lower ones on the channels they have a level for.
+ *
+ * @param[in] layer Layer, 0 (bottom) to CONFIG_LED_ANIM_LAYERS - 1 (top).
+ * @param[in] timeline Timeline to play.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if a parameter is invalid.
+ */
+int32_t led_anim_play(uint8_t layer, const struct led_anim_timeline *timeline);
+
+/**
+ * @brief Stops a layer. Channels no layer has a level for are turned off.
+ *
+ * @param[in] layer Layer to stop.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if the layer is invalid.
+ */
+int32_t led_anim_stop(uint8_t layer);
+
+/**
+ * @brief Plays and stops several layers at once, as led_anim_play() and led_anim_stop() 
+ *        would. All changes show in the same frame, no frame composites only some of 
+ *        them. Nothing changes if one of them is invalid.
+ *
+ * @param[in] changes Layer changes.
+ * @param[in] count Number of changes.
+ *
+ * @retval 0 on success.
+ * @retval -EINVAL if a change is invalid.
+ */
+int32_t led_anim_apply(const struct led_anim_change *changes, size_t count);
+
+/**
+ * @brief Forgets the levels last written, every channel is written at the next frame.
+ *        Call after the device was reset or written to outside of the engine.
+ */
+void led_anim_sync(void);
+
+/**
+ * @brief Gets the compositor statistics.
+ *
+ * @param[out] stats Compositor statistics.
+ */
+void led_anim_get_stats(struct led_anim_stats *stats);
+
+
+#endif /* LED_ANIM_H_ */
@@ -0,0 +1,106 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       profile.h
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Vehicle profile registry. Every profile linked in registers itself with
+ *             PROFILE_DEFINE(); one of them is picked at boot (from settings when enabled,
+ *             else CONFIG_PROFILE_DEFAULT) and only that one is initialised. A profile
+ *             keeps its variable state in the profile RAM arena, which only the running
+ *             one uses. Statics that must exist before init, such as bus work items and
+ *             observers, still take RAM in every profile linked in.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/shell/shell.h>
+
+
+#define PROFILE_NAME_LEN_MAX           16
+
+// LED channels of the LED drivers, in channel order
+struct profile_led_map {
+   const char *const *names;        // Name of every channel, e.g., "red_f_l"
+   uint8_t cnt;
+};
+
+// Drive commands outside of these are rejected
+struct profile_motor_limits {
+   int16_t throttle_permille_max;   // Largest |throttle| in permille
+   int32_t steering_pos_max;        // Largest |steering position| in steps
+};
+
+struct profile {
+   const char *name;
+   // Initialises the profile, ram is ram_size zeroed bytes of the arena (NULL if 0)
+   int32_t (*init)(void *ram);
+   size_t ram_size;
+   const struct profile_led_map *led_map;
+   const struct profile_motor_limits *motor_limits;
+   // Shell commands, ended by SHELL_SUBCMD_SET_END, run with "rc <cmd>"
+   const struct shell_static_entry *cmds;
+};
+
+// Registers a profile. _ram_type is the type of the profile state placed in the arena
+#define PROFILE_DEFINE(_name, _init, _ram_type, _led_map, _motor_limits, _cmds)  \
+   BUILD_ASSERT(sizeof(_ram_type) <= CONFIG_PROFILE_RAM_SIZE,                 \
+      "CONFIG_PROFILE_RAM_SIZE too small for profile " #_name);              \
+   BUILD_ASSERT(sizeof(#_name) <= PROFILE_NAME_LEN_MAX + 1,                   \
+      "Profile name too long");                                              \
+   const STRUCT_SECTION_ITERABLE(profile, profile_##_name) = {               \
+      .name = #_name,                                                        \
+      .init = _init,                                                         \
+      .ram_size = sizeof(_ram_type),                                         \
+      .led_map = _led_map,                                                   \
+      .motor_limits = _motor_limits,                                         \
+      .cmds = _cmds,                                                         \
+   }
+
+
+/**
+ * @brief Picks the profile to run and initialises it. Called once from main.
+ *
+ * @retval 0 on success.
+ * @retval -ENOENT if no profile is linked in.
+ * @retval Error code of the profile init on failure.
+ */
+int32_t profile_init(void);
+
+/**
+ * @brief Gets the running profile.
+ *
+ * @retval Running profile, NULL before profile_init() succeeded.
+ */
+const struct profile *profile_get(void);
+
+/**
+ * @brief Finds a profile by name.
+ *
+ * @param[in] name Profile name.
+ *
+ * @retval Profile, NULL if there is none with this name.
+ */
+const struct profile *profile_find(const char *name);
+
+/**
+ * @brief Stores the profile to run from the next boot on. Needs CONFIG_PROFILE_SETTINGS.
+ *
+ * @param[in] name Profile name.
+ *
+ * @retval 0 on success.
+ * @retval -ENOENT if there is no profile with this name.
+ * @retval -ENOTSUP without CONFIG_PROFILE_SETTINGS.
+ * @retval Error code on failure.
+ */
+int32_t profile_select(const char *name);
+
+
+#endif /* PROFILE_H_ */
@@ -14,6 +14,7 @@
 #define PROFILE_TINYRC_H_
 
 #include <zephyr/types.h>
+#include <zephyr/shell/shell.h>
 
 
 // LED colour mapping
@@ -62,8 +63,36 @@
 #define TINYRC_LED_BRI_DEFAULT_BACK    10
 #define TINYRC_LED_BRI_BLINKER_FRONT   100
 #define TINYRC_LED_BRI_BLINKER_BACK    100
+#define TINYRC_LED_BRI_BRAKE           100
+#define TINYRC_LED_BRI_REVERSE         100
+
+// LED colour balance, percentage applied to each colour so that equal brightness 
+// percentages mix to white. Tune for the fitted RGB LEDs
+#define TINYRC_LED_BAL_RED             100
+#define TINYRC_LED_BAL_GRE             100
+#define TINYRC_LED_BAL_BLU             100
+
+// Colour balanced brightness percentage, and the matching LED level (needs ltc3220.h). 
+// Constant arguments fold at compile time
+#define TINYRC_LED_BAL_PER(col, per)   (((per) * TINYRC_LED_BAL_##col) / 100)
+#define TINYRC_LED_LVL(col, per)       LTC3220_PERCENT_TO_LVL(TINYRC_LED_BAL_PER(col, per))
+// Levels of one RGB LED, in LED number order (red, blue, green)
+#define TINYRC_LED_LVL_RBG(per)        TINYRC_LED_LVL(RED, per), TINYRC_LED_LVL(BLU, per), \
+                                       TINYRC_LED_LVL(GRE, per)
 
 #define TINYRC_LED_BLINKER_PERIOD_MS   250
+#define TINYRC_LED_FADE_MS             480
+// Brake lights stay on for this long after the last deceleration
+#define TINYRC_LED_BRAKE_HOLD_MS       1000
+// Blinkers turn on past this steering position, either side of the centre (0)
+#define TINYRC_LED_BLINKER_STEER_POS   40
+
+// Battery status and voltage are published at least this often
+#define TINYRC_BAT_PUB_PERIOD_MS       10000
+
+// Drive limits of the tinyRC chassis, either side of stopped/centre (0)
+#define TINYRC_THROTTLE_PERMILLE_MAX   1000
+#define TINYRC_STEERING_POS_MAX        100
 
 typedef enum {
    TINYRC_BLINKER_LEFT = 0,
@@ -77,7 +106,16 @@ int32_t tinyrc_led_set_allonoff(bool on);
 
 int32_t tinyrc_led_set_blinker(tinyrc_blinker_side_t side, bool enable);
 
-int32_t tinyrc_init(void);
+int32_t tinyrc_led_set_brake(bool enable);
+
+int32_t tinyrc_led_set_reverse(bool enable);
+
+int32_t tinyrc_drive(int16_t throttle_permille, int32_t steering_pos);
+
+int32_t tinyrc_stop(void);
+
+// Shell commands of the profile, run with "rc <cmd>"
+extern const struct shell_static_entry tinyrc_shell_cmds[];
 
 
 #endif /* PROFILE_TINYRC_H_ */
@@ -18,6 +18,9 @@
 #include <zephyr/devicetree.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/gpio.h>
+#if CONFIG_MCP73831_VBAT
+#include <zephyr/drivers/adc.h>
+#endif
 
 #include <errno.h>
 
@@ -28,29 +31,133 @@ LOG_MODULE_REGISTER(LOG_MCP73831);
 
 #define DT_DRV_COMPAT mt_mcp73831
 
+#if CONFIG_MCP73831_VBAT
+BUILD_ASSERT(DT_NODE_HAS_PROP(DT_ALIAS(mcp73831), io_channels),
+   "CONFIG_MCP73831_VBAT needs 'io-channels' on the mcp73831 node");
+#endif
 
 struct mcp73831_config
 {
    struct gpio_dt_spec stat_gpio;
    int32_t maxcharge_ma;
+#if CONFIG_MCP73831_VBAT
+   struct adc_dt_spec vbat_adc;
+   uint32_t vbat_output_ohms;
+   uint32_t vbat_full_ohms;
+#endif
 };
 
 struct mcp73831_data {
    const struct device *dev;
+   struct gpio_callback stat_cb;
+   bat_charger_cb_t cb;
+   void *user_data;
 };
 
 
 static int32_t mcp73831_get_status(const struct device *dev)
 {
-   // TODO: get the STAT signal and indicate if charging or not
+   const struct mcp73831_config *cfg = dev->config;
+   int32_t ret;
+
+   // STAT is driven low while charging, high or high-Z (pulled up) otherwise
+   ret = gpio_pin_get_dt(&cfg->stat_gpio);
+   if (ret < 0)
+   {
+      LOG_ERR("Unable to read stat_gpio pin, err: %d", ret);
+      return ret;
+   }
+
+   return (ret == 0) ? BAT_CHARGER_STATUS_CHARGING : BAT_CHARGER_STATUS_NOT_CHARGING;
+}
+
+static void mcp73831_stat_changed(const struct device *port, struct gpio_callback *cb, 
+   uint32_t pins)
+{
+   ARG_UNUSED(port);
+   ARG_UNUSED(pins);
+   struct mcp73831_data *data = CONTAINER_OF(cb, struct mcp73831_data, stat_cb);
+   bat_charger_cb_t user_cb = data->cb;
+
+   if (user_cb != NULL) {
+      user_cb(data->dev, data->user_data);
+   }
+}
+
+static int32_t mcp73831_set_callback(const struct device *dev, bat_charger_cb_t cb, 
+   void *user_data)
+{
+   struct mcp73831_data *data = dev->data;
+   const struct mcp73831_config *cfg = dev->config;
+   int32_t ret;
+
+   // No edge is seen while the callback is being changed
+   ret = gpio_pin_interrupt_configure_dt(&cfg->stat_gpio, GPIO_INT_DISABLE);
+   if (ret != 0)
+   {
+      LOG_ERR("Unable to configure stat_gpio interrupt, err: %d", ret);
+      return ret;
+   }
+   data->cb = cb;
+   data->user_data = user_data;
+   if (cb == NULL) {
+      return 0;
+   }
+
+   ret = gpio_pin_interrupt_configure_dt(&cfg->stat_gpio, GPIO_INT_EDGE_BOTH);
+   if (ret != 0)
+   {
+      LOG_ERR("Unable to configure stat_gpio interrupt, err: %d", ret);
+      return ret;
+   }
 
    return 0;
 }
 
+static int32_t mcp73831_get_voltage(const struct device *dev, uint32_t *voltage_mv)
+{
+#if CONFIG_MCP73831_VBAT
+   const struct mcp73831_config *cfg = dev->config;
+   int16_t raw;
+   int32_t mv;
+   int32_t ret;
+   struct adc_sequence seq = {
+      .buffer = &raw,
+      .buffer_size = sizeof(raw),
+   };
+
+   (void)adc_sequence_init_dt(&cfg->vbat_adc, &seq);
+   ret = adc_read(cfg->vbat_adc.dev, &seq);
+   if (ret != 0)
+   {
+      LOG_ERR("Unable to read the battery voltage, err: %d", ret);
+      return ret;
+   }
+   mv = raw;
+   ret = adc_raw_to_millivolts_dt(&cfg->vbat_adc, &mv);
+   if (ret != 0) {
+      return ret;
+   }
+
+   // Single ended inputs read slightly below zero at 0 V
+   *voltage_mv = (mv <= 0) ? 0 : 
+      (uint32_t)(((uint64_t)mv * cfg->vbat_full_ohms) / cfg->vbat_output_ohms);
+
+   return 0;
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(voltage_mv);
+
+   return -ENOTSUP;
+#endif
+}
+
 static int32_t mcp73831_init(const struct device *dev)
 {
    int32_t ret;
+   struct mcp73831_data *data = dev->data;
    const struct mcp73831_config *cfg = dev->config;
+   data->dev = dev;
    
    // Enable GPIO
    if (!device_is_ready(cfg->stat_gpio.port))
@@ -64,6 +171,27 @@ static int32_t mcp73831_init(const struct device *dev)
       LOG_ERR("Unable to configure stat_gpio pin");
       return ret;
    }
+   gpio_init_callback(&data->stat_cb, mcp73831_stat_changed, BIT(cfg->stat_gpio.pin));
+   ret = gpio_add_callback(cfg->stat_gpio.port, &data->stat_cb);
+   if (ret != 0)
+   {
+      LOG_ERR("Unable to add stat_gpio callback");
+      return ret;
+   }
+
+#if CONFIG_MCP73831_VBAT
+   if (!device_is_ready(cfg->vbat_adc.dev))
+   {
+      LOG_ERR("ADC device %s is not ready", cfg->vbat_adc.dev->name);
+      return -EINVAL;
+   }
+   ret = adc_channel_setup_dt(&cfg->vbat_adc);
+   if (ret != 0)
+   {
+      LOG_ERR("Unable to configure the battery voltage channel");
+      return ret;
+   }
+#endif
 
    LOG_INF("MCP73831 driver successfully initialized");
 
@@ -73,6 +201,8 @@ static int32_t mcp73831_init(const struct device *dev)
 
 static const struct bat_charger_api drv_api = {
    .get_status = mcp73831_get_status,
+   .set_callback = mcp73831_set_callback,
+   .get_voltage = mcp73831_get_voltage,
 };
 
 // Driver instantiation macro
@@ -83,6 +213,10 @@ static const struct bat_charger_api drv_api = {
    static const struct mcp73831_config mcp73831_config##inst = {           \
       .stat_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(mcp73831), stat_gpios),       \
       .maxcharge_ma = DT_PROP(DT_ALIAS(mcp73831), maxcharge_ma),           \
+      IF_ENABLED(CONFIG_MCP73831_VBAT, (                                   \
+      .vbat_adc = ADC_DT_SPEC_GET(DT_ALIAS(mcp73831)),                     \
+      .vbat_output_ohms = DT_PROP(DT_ALIAS(mcp73831), vbat_output_ohms),   \
+      .vbat_full_ohms = DT_PROP(DT_ALIAS(mcp73831), vbat_full_ohms),))     \
    };                                                                      \
                                                                            \
    DEVICE_DT_INST_DEFINE(inst,                                             \
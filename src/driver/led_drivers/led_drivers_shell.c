@@ -19,6 +19,7 @@
 #include <driver/led_drivers/led_drivers.h>
 
 
+
 static const struct device *dev_led_drivers = DEVICE_DT_GET_ONE(adi_ltc3220);
 
 
@@ -28,14 +29,14 @@ static int32_t cmd_on(const struct shell *sh, size_t argc, char **argv)
    int32_t ret = 0;
    char *end;
    
-   float arg_led_num = strtof(argv[1], &end);
-   if (*end != '\0')
+   uint32_t arg_led_num = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_led_num > UINT8_MAX))
    {
       shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
       return -EINVAL;
    }
-   float arg_led_per = strtof(argv[2], &end);
-   if (*end != '\0')
+   uint32_t arg_led_per = strtoul(argv[2], &end, 10);
+   if ((*end != '\0') || (arg_led_per > 100))
    {
       shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
       return -EINVAL;
@@ -54,22 +55,262 @@ static int32_t cmd_on(const struct shell *sh, size_t argc, char **argv)
 static int32_t cmd_allon(const struct shell *sh, size_t argc, char **argv)
 {
    ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
    int32_t ret = 0;
-   const struct ltc3220_config *cfg = dev_led_drivers->config;
 
-   for (uint8_t i = 0; i < cfg->led_count; i++)
+   ret = led_drivers_set_all(dev_led_drivers, LTC3220_PERCENT_TO_LVL(100));
+   if (ret != 0)
    {
-      ret = led_drivers_set_led(dev_led_drivers, i, 100);
-      if (ret != 0)
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_all(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_led_lvl = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_led_lvl > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_all(dev_led_drivers, arg_led_lvl);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_leds(const struct shell *sh, size_t argc, char **argv)
+{
+   uint8_t levels[LTC3220_TOTAL_LEDS];
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_first = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_first > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   for (uint8_t i = 2; i < argc; i++)
+   {
+      uint32_t arg_led_lvl = strtoul(argv[i], &end, 10);
+      if ((*end != '\0') || (arg_led_lvl > UINT8_MAX))
       {
-         shell_lib_error(sh, "ret err %d", ret);
-         return -EIO;
+         shell_lib_error(sh, "Invalid arg[%d]: %s", (int32_t)i, argv[i]);
+         return -EINVAL;
       }
+      levels[i - 2] = arg_led_lvl;
+   }
+
+   ret = led_drivers_set_leds(dev_led_drivers, arg_first, argc - 2, levels);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_mode(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_first = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_first > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   uint32_t arg_count = strtoul(argv[2], &end, 10);
+   if ((*end != '\0') || (arg_count > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+   uint32_t arg_mode = strtoul(argv[3], &end, 10);
+   if ((*end != '\0') || (arg_mode > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[3]: %s", argv[3]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_mode(dev_led_drivers, arg_first, arg_count, arg_mode);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_blink(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_on_ms = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_on_ms > UINT16_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   uint32_t arg_period_ms = strtoul(argv[2], &end, 10);
+   if ((*end != '\0') || (arg_period_ms > UINT16_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_blink(dev_led_drivers, arg_on_ms, arg_period_ms);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_grad(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_ramp_ms = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_ramp_ms > UINT16_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   if ((strcmp(argv[2], "up") != 0) && (strcmp(argv[2], "down") != 0))
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_grad(dev_led_drivers, arg_ramp_ms, strcmp(argv[2], "up") == 0);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
    }
 
 	return 0;
 }
 
+static int32_t cmd_lvl(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+   
+   uint32_t arg_led_num = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_led_num > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   uint32_t arg_led_lvl = strtoul(argv[2], &end, 10);
+   if ((*end != '\0') || (arg_led_lvl > UINT8_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_led_level(dev_led_drivers, arg_led_num, arg_led_lvl);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
+static int32_t cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   struct led_drivers_stats stats;
+   int32_t ret = 0;
+
+   ret = led_drivers_get_stats(dev_led_drivers, &stats);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   shell_lib_print(sh, "i2c xfers: %d, bytes: %d, bytes saved: %d", stats.i2c_xfers, 
+      stats.i2c_bytes, stats.i2c_bytes_saved);
+   shell_lib_print(sh, "async errors: %d, dropped: %d", stats.async_errors, 
+      stats.async_dropped);
+
+   return 0;
+}
+
+static int32_t cmd_async(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+
+   if ((strcmp(argv[1], "on") != 0) && (strcmp(argv[1], "off") != 0))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_async(dev_led_drivers, strcmp(argv[1], "on") == 0);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_supply(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_supply_mv = strtoul(argv[1], &end, 10);
+   if (*end != '\0')
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+
+   ret = led_drivers_set_supply(dev_led_drivers, arg_supply_mv);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
 static int32_t cmd_rst(const struct shell *sh, size_t argc, char **argv)
 {
    ARG_UNUSED(argc);
@@ -89,8 +330,19 @@ static int32_t cmd_rst(const struct shell *sh, size_t argc, char **argv)
 
 SHELL_STATIC_SUBCMD_SET_CREATE(led_drivers_cmd,
 	SHELL_CMD_ARG(on, NULL, "led_drivers on [led#] [percent]", cmd_on, 3, 0),
-	SHELL_CMD_ARG(allon, NULL, "led_drivers rst", cmd_allon, 1, 0),
+	SHELL_CMD_ARG(lvl, NULL, "led_drivers lvl [led#] [level 0-63]", cmd_lvl, 3, 0),
+	SHELL_CMD_ARG(leds, NULL, "led_drivers leds [first led#] [level 0-63] ...", cmd_leds, 3, 
+      LTC3220_TOTAL_LEDS - 1),
+	SHELL_CMD_ARG(all, NULL, "led_drivers all [level 0-63]", cmd_all, 2, 0),
+	SHELL_CMD_ARG(allon, NULL, "led_drivers allon", cmd_allon, 1, 0),
+	SHELL_CMD_ARG(mode, NULL, "led_drivers mode [first led#] [count] [0 normal|1 blink|2 grad]", 
+      cmd_mode, 4, 0),
+	SHELL_CMD_ARG(blink, NULL, "led_drivers blink [on ms] [period ms]", cmd_blink, 3, 0),
+	SHELL_CMD_ARG(grad, NULL, "led_drivers grad [ramp ms, 0 off] [up|down]", cmd_grad, 3, 0),
+	SHELL_CMD_ARG(async, NULL, "led_drivers async [on|off]", cmd_async, 2, 0),
+	SHELL_CMD_ARG(supply, NULL, "led_drivers supply [mV, 0 auto]", cmd_supply, 2, 0),
 	SHELL_CMD_ARG(rst, NULL, "led_drivers rst", cmd_rst, 1, 0),
+	SHELL_CMD_ARG(stats, NULL, "led_drivers stats", cmd_stats, 1, 0),
 	SHELL_SUBCMD_SET_END // Array terminated
 );
 SHELL_CMD_REGISTER(led_drivers, &led_drivers_cmd, "led drivers driver cmds", NULL);
@@ -17,8 +17,11 @@
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
 
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <driver/led_drivers/ltc3220.h>
 #include <driver/led_drivers/led_drivers.h>
@@ -27,45 +30,690 @@ LOG_MODULE_REGISTER(LOG_LTC3220);
 
 #define DT_DRV_COMPAT adi_ltc3220
 
+#define LTC3220_LVL_LUT_ENTRY(per, _)  LTC3220_PERCENT_TO_LVL(per)
 
-static int32_t ltc3220_set_led(const struct device *dev, const uint8_t led_num, 
-   const uint8_t on_percent)
+
+// LED on percentage to LED level on the Kconfig selected curve, computed at compile time
+static const uint8_t ltc3220_lvl_lut[101] = {
+   LISTIFY(101, LTC3220_LVL_LUT_ENTRY, (,))
+};
+
+// ULED mode bits for each enum LED_DRIVERS_MODE
+static const uint8_t ltc3220_mode_bits[LED_DRIVERS_MODE_CNT] = {
+   [LED_DRIVERS_MODE_NORMAL] = LTC3220_ULED_MODE_NORMAL,
+   [LED_DRIVERS_MODE_BLINK] = LTC3220_ULED_MODE_BLINK,
+   [LED_DRIVERS_MODE_GRAD] = LTC3220_ULED_MODE_GRAD,
+};
+
+// GRAD_BLINK blink field values, from the datasheet
+static const struct {
+   uint16_t on_ms;
+   uint16_t period_ms;
+} ltc3220_blink_timing[] = {
+   { 625, 1250 },
+   { 156, 1250 },
+   { 625, 2500 },
+   { 156, 2500 },
+};
+
+// GRAD_BLINK gradation field values, from the datasheet. 0 disables gradation
+static const uint16_t ltc3220_grad_ramp_ms[] = { 0, 240, 480, 960 };
+
+
+static bool ltc3220_shadow_match(const struct ltc3220_data *data, const uint8_t reg, 
+   const uint8_t val)
+{
+   return (data->shadow_valid & BIT(reg)) && (data->shadow[reg] == val);
+}
+
+static void ltc3220_lock(struct ltc3220_data *data)
+{
+   k_mutex_lock(&data->lock, K_FOREVER);
+#if CONFIG_LTC3220_ASYNC
+   // Registers of failed asynchronous writes are unknown again
+   data->shadow_valid &= ~(uint32_t)atomic_clear(&data->async.invalid);
+#endif
+}
+
+static void ltc3220_unlock(struct ltc3220_data *data)
+{
+   k_mutex_unlock(&data->lock);
+}
+
+static uint8_t ltc3220_shadow_get(const struct ltc3220_data *data, const uint8_t reg)
+{
+   // Every register resets to 0 (normal mode, LED off, no blink or gradation)
+   return (data->shadow_valid & BIT(reg)) ? data->shadow[reg] : 0;
+}
+
+static uint32_t ltc3220_write_mask(const uint8_t reg, const uint8_t *vals, const uint8_t n)
+{
+   // Registers a write may change. With quick-write set, the ULED1 byte goes to all 18 
+   // ULED registers, a failed write leaves every register unknown
+   if ((reg == LTC3220_COMMAND) && (n > 1) && (vals[0] & LTC3220_COMMAND_QCKWR_MASK)) {
+      return BIT_MASK(LTC3220_REG_CNT);
+   }
+
+   return BIT_MASK(n) << reg;
+}
+
+#if CONFIG_LTC3220_ASYNC
+static void ltc3220_async_start(const struct device *dev);
+
+static void ltc3220_async_done(const struct device *i2c_dev, int result, void *user_data)
+{
+   ARG_UNUSED(i2c_dev);
+   const struct device *dev = user_data;
+   struct ltc3220_data *data = dev->data;
+   struct ltc3220_async *async = &data->async;
+   bool next;
+
+   k_spinlock_key_t key = k_spin_lock(&async->lock);
+   if (result != 0)
+   {
+      // The write may or may not have reached the device
+      atomic_or(&async->invalid, async->queue[async->head].mask);
+      async->errors++;
+   }
+   async->head = (async->head + 1) % CONFIG_LTC3220_ASYNC_QUEUE_DEPTH;
+   async->count--;
+   next = (async->count != 0);
+   k_spin_unlock(&async->lock, key);
+
+   if ((result != 0) && (async->cb != NULL)) {
+      async->cb(dev, result, async->user_data);
+   }
+   if (next) {
+      ltc3220_async_start(dev);
+   }
+   else {
+      k_sem_give(&async->idle);
+   }
+}
+
+static void ltc3220_async_start(const struct device *dev)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   struct ltc3220_async *async = &data->async;
+
+   // Only the queue head is ever on the bus, it stays in place until completed
+   ret = i2c_transfer_cb_dt(&data->i2c, &async->queue[async->head].msg, 1, 
+      ltc3220_async_done, (void *)dev);
+   if (ret != 0) {
+      ltc3220_async_done(data->i2c.bus, ret, (void *)dev);
+   }
+}
+
+static int32_t ltc3220_async_submit(const struct device *dev, const uint8_t reg, 
+   const uint8_t *vals, const uint8_t n)
+{
+   struct ltc3220_data *data = dev->data;
+   struct ltc3220_async *async = &data->async;
+   struct ltc3220_xfer *xfer;
+   bool start;
+
+   k_spinlock_key_t key = k_spin_lock(&async->lock);
+   if (async->count == CONFIG_LTC3220_ASYNC_QUEUE_DEPTH)
+   {
+      async->dropped++;
+      k_spin_unlock(&async->lock, key);
+      return -ENOBUFS;
+   }
+   xfer = &async->queue[(async->head + async->count) % CONFIG_LTC3220_ASYNC_QUEUE_DEPTH];
+   xfer->buf[0] = reg;
+   memcpy(&xfer->buf[1], vals, n);
+   xfer->msg.buf = xfer->buf;
+   xfer->msg.len = 1 + n;
+   xfer->msg.flags = I2C_MSG_WRITE | I2C_MSG_STOP;
+   xfer->mask = ltc3220_write_mask(reg, vals, n);
+   start = (async->count == 0);
+   async->count++;
+   k_spin_unlock(&async->lock, key);
+
+   if (start) {
+      ltc3220_async_start(dev);
+   }
+
+   return 0;
+}
+#endif
+
+static int32_t ltc3220_i2c_write(const struct device *dev, const uint8_t reg, 
+   const uint8_t *vals, const uint8_t n)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+
+   // Called with lock held, one transaction as the register address auto-increments.
+   // Asynchronous writes update the shadow when queued, a failure invalidates it later
+#if CONFIG_LTC3220_ASYNC
+   if (data->async.enabled) {
+      ret = ltc3220_async_submit(dev, reg, vals, n);
+   }
+   else {
+      ret = i2c_burst_write_dt(&data->i2c, reg, vals, n);
+   }
+#else
+   ret = i2c_burst_write_dt(&data->i2c, reg, vals, n);
+#endif
+   if (ret != 0)
+   {
+      // The write may or may not have reached the device
+      data->shadow_valid &= ~ltc3220_write_mask(reg, vals, n);
+      LOG_ERR("Failed to write LTC3220 reg 0x%02X (%d bytes), err: %d", reg, (int32_t)n, ret);
+      return ret;
+   }
+   memcpy(&data->shadow[reg], vals, n);
+   data->shadow_valid |= BIT_MASK(n) << reg;
+   data->i2c_xfers++;
+   data->i2c_bytes += LTC3220_I2C_WRITE_OVERHEAD + n;
+
+   return 0;
+}
+
+static int32_t ltc3220_regs_write(const struct device *dev, const uint8_t reg, 
+   const uint8_t *vals, const uint8_t n)
+{
+   struct ltc3220_data *data = dev->data;
+   uint8_t buf[LTC3220_REG_CNT];
+   uint8_t first = reg;
+   uint8_t last = reg + n - 1;
+
+   // Called with lock held. Registers are write-only, the shadow is all we know of them:
+   // unchanged registers at either end of the range are not sent
+   while ((first <= last) && ltc3220_shadow_match(data, first, vals[first - reg])) {
+      first++;
+   }
+   if (first > last)
+   {
+      data->i2c_bytes_saved += LTC3220_I2C_WRITE_OVERHEAD + n;
+      return 0;
+   }
+   while (ltc3220_shadow_match(data, last, vals[last - reg])) {
+      last--;
+   }
+   data->i2c_bytes_saved += n - (last - first + 1);
+   memcpy(&buf[1], &vals[first - reg], last - first + 1);
+
+   // Quick-write left on by set_all would copy ULED1 to every LED, turn it off in the 
+   // same transaction
+   if ((first == LTC3220_ULED1) && (ltc3220_shadow_get(data, LTC3220_COMMAND) & LTC3220_COMMAND_QCKWR_MASK))
+   {
+      buf[0] = ltc3220_shadow_get(data, LTC3220_COMMAND) & ~LTC3220_COMMAND_QCKWR_MASK;
+      return ltc3220_i2c_write(dev, LTC3220_COMMAND, buf, last + 1);
+   }
+
+   return ltc3220_i2c_write(dev, first, &buf[1], last - first + 1);
+}
+
+static uint8_t ltc3220_cp_mode(const struct device *dev, const uint8_t max_lvl)
+{
+   struct ltc3220_data *data = dev->data;
+   const struct ltc3220_config *cfg = dev->config;
+   uint32_t need_mv = cfg->led_vf_mv + (cfg->cp_headroom_mv * max_lvl) / LTC3220_LVL_MAX;
+
+   // Unknown supply, let the charge pump switch on dropout itself
+   if (data->supply_mv == 0) {
+      return LTC3220_COMMAND_MODE_AUTO;
+   }
+
+   // Lowest gain that keeps the brightest LED out of dropout
+   if (data->supply_mv >= need_mv) {
+      return LTC3220_COMMAND_MODE_1X;
+   }
+   if (((data->supply_mv * 3) / 2) >= need_mv) {
+      return LTC3220_COMMAND_MODE_1P5X;
+   }
+
+   return LTC3220_COMMAND_MODE_2X;
+}
+
+static uint8_t ltc3220_cmd_power(const struct device *dev, const uint8_t max_lvl)
+{
+   struct ltc3220_data *data = dev->data;
+
+   // Software shutdown keeps the registers, only the serial port stays on
+   if (data->suspended || (max_lvl == 0)) {
+      return LTC3220_COMMAND_SHDWN_MASK;
+   }
+
+   return ltc3220_cp_mode(dev, max_lvl);
+}
+
+static int32_t ltc3220_cmd_update(const struct device *dev)
+{
+   struct ltc3220_data *data = dev->data;
+   const struct ltc3220_config *cfg = dev->config;
+   uint8_t cmd = ltc3220_shadow_get(data, LTC3220_COMMAND) & LTC3220_COMMAND_QCKWR_MASK;
+   uint8_t max_lvl = 0;
+
+   // Called with lock held, after the LED levels changed. LEDs not known to be off 
+   // count as fully on
+   for (uint8_t reg = LTC3220_ULED1; reg < (LTC3220_ULED1 + cfg->led_count); reg++)
+   {
+      uint8_t lvl = (data->shadow_valid & BIT(reg)) ? 
+         (data->shadow[reg] & LTC3220_ULED1_TO_18_LED_MASK) : LTC3220_LVL_MAX;
+      max_lvl = MAX(max_lvl, lvl);
+   }
+   cmd |= ltc3220_cmd_power(dev, max_lvl);
+
+   return ltc3220_regs_write(dev, LTC3220_COMMAND, &cmd, 1);
+}
+
+static int32_t ltc3220_set_led_level(const struct device *dev, const uint8_t led_num, 
+   const uint8_t level)
 {
    int32_t ret = 0;
    struct ltc3220_data *data = dev->data;
    const struct ltc3220_config *cfg = dev->config;
-   uint8_t data_tx[2] = { led_num + 1, 0x00 };
+   uint8_t val;
 
    // Ensure params are good
-   if ((led_num < 0) || (led_num >= cfg->led_count) ||
-      (on_percent < 0) || (on_percent > 100))
+   if ((led_num >= cfg->led_count) || (level >= LTC3220_MAX_LED_LVL))
+   {
+      LOG_ERR("Invalid parameter, led_num: %d, level: %d", (int32_t)led_num, 
+         (int32_t)level);
+      return -EINVAL;
+   }
+
+   // A blinking or fading LED keeps doing so at its new level
+   ltc3220_lock(data);
+   val = (ltc3220_shadow_get(data, LTC3220_ULED1 + led_num) & LTC3220_ULED1_TO_18_MODE_MASK) | 
+      level;
+   ret = ltc3220_regs_write(dev, LTC3220_ULED1 + led_num, &val, 1);
+   if (ret == 0) {
+      ret = ltc3220_cmd_update(dev);
+   }
+   ltc3220_unlock(data);
+   if (ret != 0) {
+      return ret;
+   }
+
+   LOG_DBG("Set LED num %d to level %d", (int32_t)led_num, (int32_t)level);
+   
+   return 0;
+}
+
+static int32_t ltc3220_set_led(const struct device *dev, const uint8_t led_num, 
+   const uint8_t on_percent)
+{
+   // Ensure params are good
+   if (on_percent > 100)
    {
       LOG_ERR("Invalid parameter, led_num: %d, on_percent: %d", (int32_t)led_num, 
          (int32_t)on_percent);
       return -EINVAL;
    }
 
-   data_tx[1] |= (uint8_t)((((float)on_percent) / 100.0) * 
-      ((float)LTC3220_MAX_LED_LVL - 1.0));
-   ret = i2c_burst_write_dt(&data->i2c, data_tx[0], &data_tx[1], 1);
-   if (ret != 0)
+   return ltc3220_set_led_level(dev, led_num, ltc3220_lvl_lut[on_percent]);
+}
+
+static int32_t ltc3220_set_leds(const struct device *dev, const uint8_t first, 
+   const uint8_t count, const uint8_t *levels)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   const struct ltc3220_config *cfg = dev->config;
+   uint8_t buf[LTC3220_TOTAL_LEDS];
+
+   // Ensure params are good
+   if ((count == 0) || ((first + count) > cfg->led_count))
    {
-      LOG_ERR("Failed to write LTC3220 reg 0x%02X, err: %d", data_tx[0], ret);
-      return ret;
+      LOG_ERR("Invalid parameter, first: %d, count: %d", (int32_t)first, (int32_t)count);
+      return -EINVAL;
+   }
+   for (uint8_t i = 0; i < count; i++)
+   {
+      if (levels[i] >= LTC3220_MAX_LED_LVL)
+      {
+         LOG_ERR("Invalid parameter, led_num: %d, level: %d", (int32_t)(first + i), 
+            (int32_t)levels[i]);
+         return -EINVAL;
+      }
    }
 
-   LOG_DBG("Set LED num %d to %d%%", (int32_t)led_num, (int32_t)on_percent);
-   
+   ltc3220_lock(data);
+   for (uint8_t i = 0; i < count; i++)
+   {
+      buf[i] = (ltc3220_shadow_get(data, LTC3220_ULED1 + first + i) & 
+         LTC3220_ULED1_TO_18_MODE_MASK) | levels[i];
+   }
+   ret = ltc3220_regs_write(dev, LTC3220_ULED1 + first, buf, count);
+   if (ret == 0) {
+      ret = ltc3220_cmd_update(dev);
+   }
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
+static int32_t ltc3220_set_all(const struct device *dev, const uint8_t level)
+{
+   int32_t ret = 0;
+   bool match = true;
+   struct ltc3220_data *data = dev->data;
+   uint8_t buf[2];
+
+   // Ensure params are good
+   if (level >= LTC3220_MAX_LED_LVL)
+   {
+      LOG_ERR("Invalid parameter, level: %d", (int32_t)level);
+      return -EINVAL;
+   }
+
+   ltc3220_lock(data);
+   for (uint8_t reg = LTC3220_ULED1; reg <= LTC3220_ULED18; reg++) {
+      match = match && ltc3220_shadow_match(data, reg, level);
+   }
+   if (match)
+   {
+      data->i2c_bytes_saved += LTC3220_I2C_WRITE_OVERHEAD + sizeof(buf);
+      ltc3220_unlock(data);
+      return 0;
+   }
+
+   // With quick-write on, writing ULED1 writes all 18 ULED registers. Shutdown and 
+   // charge pump mode for the new level go out in the same write
+   buf[0] = LTC3220_COMMAND_QCKWR_MASK | ltc3220_cmd_power(dev, level);
+   buf[1] = level;
+   ret = ltc3220_i2c_write(dev, LTC3220_COMMAND, buf, sizeof(buf));
+   if (ret == 0)
+   {
+      memset(&data->shadow[LTC3220_ULED1], level, LTC3220_TOTAL_LEDS);
+      data->shadow_valid |= BIT_MASK(LTC3220_TOTAL_LEDS) << LTC3220_ULED1;
+   }
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
+static int32_t ltc3220_set_image(const struct device *dev, const uint8_t first, 
+   const uint8_t count, const uint8_t *image)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   const struct ltc3220_config *cfg = dev->config;
+   uint8_t buf[LTC3220_TOTAL_LEDS];
+   uint8_t span_first = LTC3220_ULED18 + 1, span_last = 0;
+   bool uniform;
+
+   // Ensure params are good
+   if ((count == 0) || ((first + count) > cfg->led_count))
+   {
+      LOG_ERR("Invalid parameter, first: %d, count: %d", (int32_t)first, (int32_t)count);
+      return -EINVAL;
+   }
+   for (uint8_t i = 0; i < count; i++)
+   {
+      if (LED_DRIVERS_IMG_MODE(image[i]) >= LED_DRIVERS_MODE_CNT)
+      {
+         LOG_ERR("Invalid parameter, led_num: %d, image: 0x%02X", (int32_t)(first + i), 
+            (int32_t)image[i]);
+         return -EINVAL;
+      }
+      buf[i] = ltc3220_mode_bits[LED_DRIVERS_IMG_MODE(image[i])] | LED_DRIVERS_IMG_LVL(image[i]);
+   }
+
+   // Every LED at the same level in normal mode is what quick-write does
+   uniform = (first == 0) && (count == LTC3220_TOTAL_LEDS) && 
+      (LED_DRIVERS_IMG_MODE(image[0]) == LED_DRIVERS_MODE_NORMAL);
+   for (uint8_t i = 1; uniform && (i < count); i++) {
+      uniform = (image[i] == image[0]);
+   }
+
+   ltc3220_lock(data);
+   if (uniform)
+   {
+      for (uint8_t reg = LTC3220_ULED1; reg <= LTC3220_ULED18; reg++)
+      {
+         if (!ltc3220_shadow_match(data, reg, buf[reg - LTC3220_ULED1]))
+         {
+            span_first = MIN(span_first, reg);
+            span_last = reg;
+         }
+      }
+      // Cheaper than the burst when more than the quick-write bytes differ
+      if ((span_first <= span_last) && ((span_last - span_first + 1) > 2))
+      {
+         ret = ltc3220_set_all(dev, LED_DRIVERS_IMG_LVL(image[0]));
+         ltc3220_unlock(data);
+         return ret;
+      }
+   }
+   ret = ltc3220_regs_write(dev, LTC3220_ULED1 + first, buf, count);
+   if (ret == 0) {
+      ret = ltc3220_cmd_update(dev);
+   }
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
+static int32_t ltc3220_set_mode(const struct device *dev, const uint8_t first, 
+   const uint8_t count, const uint8_t mode)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   const struct ltc3220_config *cfg = dev->config;
+   uint8_t buf[LTC3220_TOTAL_LEDS];
+
+   // Ensure params are good
+   if ((count == 0) || ((first + count) > cfg->led_count) || (mode >= LED_DRIVERS_MODE_CNT))
+   {
+      LOG_ERR("Invalid parameter, first: %d, count: %d, mode: %d", (int32_t)first, 
+         (int32_t)count, (int32_t)mode);
+      return -EINVAL;
+   }
+
+   ltc3220_lock(data);
+   for (uint8_t i = 0; i < count; i++)
+   {
+      buf[i] = (ltc3220_shadow_get(data, LTC3220_ULED1 + first + i) & 
+         LTC3220_ULED1_TO_18_LED_MASK) | ltc3220_mode_bits[mode];
+   }
+   ret = ltc3220_regs_write(dev, LTC3220_ULED1 + first, buf, count);
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
+static int32_t ltc3220_set_blink(const struct device *dev, const uint16_t on_ms, 
+   const uint16_t period_ms)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   uint32_t best_err = UINT32_MAX;
+   uint8_t best = 0;
+   uint8_t val;
+
+   // Ensure params are good
+   if ((on_ms == 0) || (on_ms >= period_ms))
+   {
+      LOG_ERR("Invalid parameter, on_ms: %d, period_ms: %d", (int32_t)on_ms, 
+         (int32_t)period_ms);
+      return -EINVAL;
+   }
+
+   // Closest period first, then closest duty cycle
+   for (uint8_t i = 0; i < ARRAY_SIZE(ltc3220_blink_timing); i++)
+   {
+      uint32_t hw_period = ltc3220_blink_timing[i].period_ms;
+      uint32_t hw_on = ltc3220_blink_timing[i].on_ms;
+      uint32_t err = ((uint32_t)abs((int32_t)hw_period - period_ms) << 16) + 
+         (abs((int32_t)(on_ms * hw_period) - (int32_t)(hw_on * period_ms)) / period_ms);
+
+      if (err < best_err)
+      {
+         best_err = err;
+         best = i;
+      }
+   }
+
+   ltc3220_lock(data);
+   val = (ltc3220_shadow_get(data, LTC3220_GRAD_BLINK) & ~LTC3220_GRAD_BLINK_BLINK_MASK) | 
+      (best << LTC3220_GRAD_BLINK_BLINK_SHIFT);
+   ret = ltc3220_regs_write(dev, LTC3220_GRAD_BLINK, &val, 1);
+   ltc3220_unlock(data);
+
+   LOG_DBG("Blink on %d ms, period %d ms", (int32_t)ltc3220_blink_timing[best].on_ms, 
+      (int32_t)ltc3220_blink_timing[best].period_ms);
+
+   return ret;
+}
+
+static int32_t ltc3220_set_grad(const struct device *dev, const uint16_t ramp_ms, 
+   const bool up)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+   uint8_t best = 0;
+   uint8_t val;
+
+   // Closest ramp time, only 0 disables gradation
+   if (ramp_ms != 0)
+   {
+      best = 1;
+      for (uint8_t i = 2; i < ARRAY_SIZE(ltc3220_grad_ramp_ms); i++)
+      {
+         if (abs((int32_t)ltc3220_grad_ramp_ms[i] - ramp_ms) < 
+               abs((int32_t)ltc3220_grad_ramp_ms[best] - ramp_ms)) {
+            best = i;
+         }
+      }
+   }
+
+   // The ramp starts when the register is written, so the write is never skipped
+   ltc3220_lock(data);
+   val = (ltc3220_shadow_get(data, LTC3220_GRAD_BLINK) & LTC3220_GRAD_BLINK_BLINK_MASK) | 
+      (best << LTC3220_GRAD_BLINK_GRAD_SHIFT) | (up ? LTC3220_GRAD_BLINK_UP_MASK : 0);
+   ret = ltc3220_i2c_write(dev, LTC3220_GRAD_BLINK, &val, 1);
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
+static int32_t ltc3220_flush(const struct device *dev, k_timeout_t timeout)
+{
+#if CONFIG_LTC3220_ASYNC
+   struct ltc3220_data *data = dev->data;
+   struct ltc3220_async *async = &data->async;
+
+   // Reset first: a drain after the check still gives the semaphore
+   k_sem_reset(&async->idle);
+   if (async->count == 0) {
+      return 0;
+   }
+
+   return k_sem_take(&async->idle, timeout);
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(timeout);
+
+   return 0;
+#endif
+}
+
+static int32_t ltc3220_set_async(const struct device *dev, const bool enable)
+{
+#if CONFIG_LTC3220_ASYNC
+   struct ltc3220_data *data = dev->data;
+   const struct i2c_driver_api *i2c_api = data->i2c.bus->api;
+
+   if (enable && (i2c_api->transfer_cb == NULL))
+   {
+      LOG_ERR("I2C driver %s has no asynchronous transfers", data->i2c.bus->name);
+      return -ENOTSUP;
+   }
+
+   // Writes made after this call must not overtake the queued ones
+   ltc3220_lock(data);
+   (void)ltc3220_flush(dev, K_FOREVER);
+   data->async.enabled = enable;
+   ltc3220_unlock(data);
+
+   LOG_DBG("Asynchronous writes %s", enable ? "enabled" : "disabled");
+
+   return 0;
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(enable);
+
+   return -ENOTSUP;
+#endif
+}
+
+static int32_t ltc3220_set_async_callback(const struct device *dev, 
+   led_drivers_async_cb_t cb, void *user_data)
+{
+#if CONFIG_LTC3220_ASYNC
+   struct ltc3220_data *data = dev->data;
+
+   // No queued write may complete while the callback and its user data are changed
+   ltc3220_lock(data);
+   (void)ltc3220_flush(dev, K_FOREVER);
+   data->async.cb = cb;
+   data->async.user_data = user_data;
+   ltc3220_unlock(data);
+
+   return 0;
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(cb);
+   ARG_UNUSED(user_data);
+
+   return -ENOTSUP;
+#endif
+}
+
+static int32_t ltc3220_get_stats(const struct device *dev, struct led_drivers_stats *stats)
+{
+   struct ltc3220_data *data = dev->data;
+
+   ltc3220_lock(data);
+   stats->i2c_xfers = data->i2c_xfers;
+   stats->i2c_bytes = data->i2c_bytes;
+   stats->i2c_bytes_saved = data->i2c_bytes_saved;
+#if CONFIG_LTC3220_ASYNC
+   k_spinlock_key_t key = k_spin_lock(&data->async.lock);
+   stats->async_errors = data->async.errors;
+   stats->async_dropped = data->async.dropped;
+   k_spin_unlock(&data->async.lock, key);
+#else
+   stats->async_errors = 0;
+   stats->async_dropped = 0;
+#endif
+   ltc3220_unlock(data);
+
    return 0;
 }
 
+static int32_t ltc3220_set_supply(const struct device *dev, const uint32_t supply_mv)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+
+   ltc3220_lock(data);
+   data->supply_mv = supply_mv;
+   ret = ltc3220_cmd_update(dev);
+   ltc3220_unlock(data);
+
+   return ret;
+}
+
 static int32_t ltc3220_rst(const struct device *dev)
 {
+   struct ltc3220_data *data = dev->data;
    const struct ltc3220_config *cfg = dev->config;
 
+   // Every register is back to its reset value, the next writes must go out
+   ltc3220_lock(data);
+   (void)ltc3220_flush(dev, K_FOREVER);
    gpio_pin_set_dt(&cfg->nrst_gpio, 0);
-   k_sleep(K_USEC(1));
+   k_busy_wait(1);
    gpio_pin_set_dt(&cfg->nrst_gpio, 1);
+   data->shadow_valid = 0;
+   ltc3220_unlock(data);
 
    LOG_DBG("LED drivers reset");
 
@@ -79,6 +727,16 @@ static int32_t ltc3220_init(const struct device *dev)
    const struct ltc3220_config *cfg = dev->config;
    data->dev = dev;
 
+   // Device state is unknown until each register is written once
+   k_mutex_init(&data->lock);
+   data->shadow_valid = 0;
+   // Charge pump in auto mode until the supply voltage is known
+   data->supply_mv = 0;
+   data->suspended = false;
+#if CONFIG_LTC3220_ASYNC
+   k_sem_init(&data->async.idle, 0, 1);
+#endif
+
    if (!device_is_ready(data->i2c.bus))
    {
       LOG_ERR("Failed to get I2C device");
@@ -104,9 +762,45 @@ static int32_t ltc3220_init(const struct device *dev)
 }
 
 
+#if CONFIG_PM_DEVICE
+static int ltc3220_pm_action(const struct device *dev, enum pm_device_action action)
+{
+   int32_t ret = 0;
+   struct ltc3220_data *data = dev->data;
+
+   if ((action != PM_DEVICE_ACTION_SUSPEND) && (action != PM_DEVICE_ACTION_RESUME)) {
+      return -ENOTSUP;
+   }
+
+   // LED levels are kept and apply again on resume. The bus may be suspended next, make
+   // sure the write is out
+   ltc3220_lock(data);
+   data->suspended = (action == PM_DEVICE_ACTION_SUSPEND);
+   ret = ltc3220_cmd_update(dev);
+   if (ret == 0) {
+      ret = ltc3220_flush(dev, K_FOREVER);
+   }
+   ltc3220_unlock(data);
+
+   return ret;
+}
+#endif
+
 static const struct led_drivers_api drv_api = {
    .rst     = ltc3220_rst,
    .set_led = ltc3220_set_led,
+   .set_led_level = ltc3220_set_led_level,
+   .set_leds = ltc3220_set_leds,
+   .set_all = ltc3220_set_all,
+   .set_image = ltc3220_set_image,
+   .set_mode = ltc3220_set_mode,
+   .set_blink = ltc3220_set_blink,
+   .set_grad = ltc3220_set_grad,
+   .set_async = ltc3220_set_async,
+   .set_async_callback = ltc3220_set_async_callback,
+   .flush = ltc3220_flush,
+   .set_supply = ltc3220_set_supply,
+   .get_stats = ltc3220_get_stats,
 };
 
 // Driver instantiation macro
@@ -119,10 +813,14 @@ static const struct led_drivers_api drv_api = {
    static const struct ltc3220_config ltc3220_config##inst = {             \
       .nrst_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(ltc3220), nrst_gpios),        \
       .led_count = DT_PROP(DT_ALIAS(ltc3220), led_count),                  \
+      .led_vf_mv = DT_PROP(DT_ALIAS(ltc3220), led_vf_mv),                  \
+      .cp_headroom_mv = DT_PROP(DT_ALIAS(ltc3220), cp_headroom_mv),        \
    };                                                                      \
                                                                            \
+   PM_DEVICE_DT_INST_DEFINE(inst, ltc3220_pm_action);                      \
+                                                                           \
    DEVICE_DT_INST_DEFINE(inst,                                             \
-                         ltc3220_init, NULL,                               \
+                         ltc3220_init, PM_DEVICE_DT_INST_GET(inst),        \
                          &ltc3220_data##inst, &ltc3220_config##inst,       \
                          POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,    \
                          &drv_api);
@@ -0,0 +1,166 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       ltc3220_emul.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      I2C emulator for LTC3220 LED drivers.
+ *
+ *             Models the register file as the device sees it: the serial port is write
+ *             only, the first byte of a write is the register address and the address
+ *             increments after every data byte. With the quick-write bit set in COMMAND, a
+ *             write to ULED1 goes to all 18 ULED registers.
+ */
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/logging/log.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <driver/led_drivers/ltc3220.h>
+#include <driver/led_drivers/ltc3220_emul.h>
+
+LOG_MODULE_REGISTER(LOG_LTC3220_EMUL);
+
+#define DT_DRV_COMPAT adi_ltc3220
+
+
+struct ltc3220_emul_data {
+   struct k_spinlock lock;
+   uint8_t regs[LTC3220_REG_CNT];
+   struct ltc3220_emul_traffic traffic;
+};
+
+
+static void ltc3220_emul_reg_write(struct ltc3220_emul_data *data, uint8_t reg, uint8_t val)
+{
+   if ((reg == LTC3220_ULED1) && (data->regs[LTC3220_COMMAND] & LTC3220_COMMAND_QCKWR_MASK)) {
+      memset(&data->regs[LTC3220_ULED1], val, LTC3220_TOTAL_LEDS);
+   }
+   else {
+      data->regs[reg] = val;
+   }
+}
+
+static int ltc3220_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+   int addr)
+{
+   struct ltc3220_emul_data *data = target->data;
+   uint32_t len = 0;
+   uint8_t reg = 0;
+   bool has_reg = false;
+
+   ARG_UNUSED(addr);
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+
+   // Refuse the whole transaction before touching any register
+   for (int i = 0; i < num_msgs; i++)
+   {
+      if (msgs[i].flags & I2C_MSG_READ)
+      {
+         data->traffic.nacks++;
+         k_spin_unlock(&data->lock, key);
+         LOG_ERR("Read from a write only device");
+         return -EIO;
+      }
+      len += msgs[i].len;
+   }
+   if ((len == 0) || (msgs[0].len == 0) || (msgs[0].buf[0] + len - 1 > LTC3220_REG_CNT))
+   {
+      data->traffic.nacks++;
+      k_spin_unlock(&data->lock, key);
+      LOG_ERR("Invalid write, length: %d", len);
+      return -EIO;
+   }
+
+   // Messages of one transaction are a single stream of bytes on the bus
+   for (int i = 0; i < num_msgs; i++)
+   {
+      for (uint32_t j = 0; j < msgs[i].len; j++)
+      {
+         if (!has_reg)
+         {
+            reg = msgs[i].buf[j];
+            has_reg = true;
+            continue;
+         }
+         ltc3220_emul_reg_write(data, reg, msgs[i].buf[j]);
+         reg++;
+      }
+   }
+   data->traffic.xfers++;
+   data->traffic.bytes += 1 + len;
+
+   k_spin_unlock(&data->lock, key);
+
+   return 0;
+}
+
+void ltc3220_emul_get_regs(const struct emul *target, uint8_t regs[LTC3220_REG_CNT])
+{
+   struct ltc3220_emul_data *data = target->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+   memcpy(regs, data->regs, LTC3220_REG_CNT);
+   k_spin_unlock(&data->lock, key);
+}
+
+void ltc3220_emul_get_traffic(const struct emul *target, struct ltc3220_emul_traffic *traffic)
+{
+   struct ltc3220_emul_data *data = target->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+   *traffic = data->traffic;
+   k_spin_unlock(&data->lock, key);
+}
+
+void ltc3220_emul_clear_traffic(const struct emul *target)
+{
+   struct ltc3220_emul_data *data = target->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+   memset(&data->traffic, 0, sizeof(data->traffic));
+   k_spin_unlock(&data->lock, key);
+}
+
+void ltc3220_emul_reset(const struct emul *target)
+{
+   struct ltc3220_emul_data *data = target->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->lock);
+   memset(data->regs, 0, sizeof(data->regs));
+   k_spin_unlock(&data->lock, key);
+}
+
+static int ltc3220_emul_init(const struct emul *target, const struct device *parent)
+{
+   ARG_UNUSED(parent);
+
+   ltc3220_emul_reset(target);
+   ltc3220_emul_clear_traffic(target);
+
+   return 0;
+}
+
+static const struct i2c_emul_api ltc3220_emul_api = {
+   .transfer = ltc3220_emul_transfer,
+};
+
+#define LTC3220_EMUL_DEFINE(inst)                                          \
+   static struct ltc3220_emul_data ltc3220_emul_data_##inst;               \
+                                                                           \
+   EMUL_DT_INST_DEFINE(inst, ltc3220_emul_init, &ltc3220_emul_data_##inst, \
+                       NULL, &ltc3220_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(LTC3220_EMUL_DEFINE)
@@ -21,16 +21,49 @@
 #include <zephyr/drivers/pwm.h>
 
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if CONFIG_MOTORS_DRV_PULSE_NRFX
+#include <soc.h>
+#endif
 
 #include <driver/motors/motors_drv.h>
+#include <driver/motors/motors_pulse.h>
+#include <driver/motors/motors_profile.h>
+#if CONFIG_MOTORS_DRV_SENSE
+#include <driver/motors/motors_sense.h>
+#endif
 
 LOG_MODULE_REGISTER(LOG_MOTORS_DRV);
 
 #define DT_DRV_COMPAT juskim_motors
 
+// 'step-period-us' is half of the STEP pulse period
+#define MOTORS_STEP_PULSE_PERIOD_US(cfg)   (2 * (cfg)->step_period_us)
+
+// DC duty cycle is handled in permille, ramps are updated every tick
+#define MOTORS_DC_DUTY_MAX                   MOTORS_DRV_DUTY_PERMILLE_MAX
+#define MOTORS_DC_RAMP_TICK_MS               1
+
+#define MOTORS_DC_PULSE(cfg, duty_pm)        MOTORS_DRV_DC_PULSE((cfg)->dc_en_pwm.period, duty_pm)
+
+// Users of the motors supply (nSLEEP + boost EN)
+#define MOTORS_PWR_USER_DC                   BIT(0)
+#define MOTORS_PWR_USER_STEP                 BIT(1)
+
+// Driver internal segment flag, the segment is the homing move
+#define MOTORS_DRV_SEG_F_HOME                BIT(7)
+
+// Soft limit from the optional 'step-soft-limits' property, or no limit
+#define MOTORS_DT_SOFT_LIMIT(node, idx, def)                                  \
+   COND_CODE_1(DT_NODE_HAS_PROP(node, step_soft_limits),                     \
+      (DT_PROP_BY_IDX(node, step_soft_limits, idx)), (def))
+
 
 struct motors_drv_config
 {
+   struct pwm_dt_spec dc_en_pwm;
    struct gpio_dt_spec nsleep_gpio;
    struct gpio_dt_spec en_gpio;
    struct gpio_dt_spec dc_ph_gpio;
@@ -38,103 +71,792 @@ struct motors_drv_config
    struct gpio_dt_spec step_dir_gpio;
    struct gpio_dt_spec step_nrst_gpio;
    int32_t step_period_us;
+   int32_t pos_min;
+   int32_t pos_max;
+   uint32_t home_steps;
+   int32_t home_pos;
+   uint16_t dc_accel_slew;
+   uint16_t dc_brake_slew;
+   uint32_t pwr_idle_ms;
+   uint32_t pwr_settle_us;
+   struct motors_drv_profile profile;
+   struct motors_pulse_cfg pulse_cfg;
+#if CONFIG_MOTORS_DRV_SENSE
+   struct motors_sense_cfg sense_cfg;
+   uint32_t sense_dc_max_ma;
+   uint32_t sense_step_max_ma;
+#endif
 };
 
 struct motors_drv_data {
    const struct device *dev;
-   const struct pwm_dt_spec dc_en_pwm;
+   struct k_spinlock pwr_lock;
+   struct k_timer pwr_settle_timer;
+   struct k_timer pwr_idle_timer;
+   uint8_t pwr_state;            // See enum MOTORS_DRV_PWR_STATE
+   uint8_t pwr_users;            // MOTORS_PWR_USER_* currently needing the supply
+   uint32_t pwr_wake_cnt;
+   int64_t pwr_on_since;
+   int64_t pwr_on_ms;
+   bool step_pending;            // Step segment waiting for the supply to settle
+   bool step_armed;              // Pulse engine count belongs to the running segment
+   struct k_spinlock dc_lock;
+   struct k_timer dc_ramp_timer;
+   int32_t dc_cur;               // Signed DC duty cycle applied now in permille
+   int32_t dc_target;            // Signed DC duty cycle the ramp is heading to in permille
+   int8_t dc_sign;
+   bool dc_ramping;
+   struct motors_pulse pulse;
+   struct motors_drv_profile profile;
+   uint32_t ramp_us[CONFIG_MOTORS_DRV_PROFILE_RAMP_LEN];
+   uint32_t ramp_len;
+   uint32_t ramp_cruise_us;
+   bool ramp_valid;
+   struct k_msgq seg_q;
+   char __aligned(4) seg_q_buf[CONFIG_MOTORS_DRV_QUEUE_DEPTH * sizeof(struct motors_drv_segment)];
+   struct k_spinlock seg_lock;
+   struct k_timer dc_hold_timer;
+   struct motors_drv_segment seg_active;
+   bool seg_running;
+   atomic_t seg_gen;             // Incremented whenever the running segment ends
+   atomic_t seg_profile_cnt;     // Queued or running segments using the cached ramp table
+   uint32_t seg_depth_max;
+   uint32_t seg_completed;
+   uint32_t seg_underruns;
+   int32_t position;             // Position at the start of the running step segment
+   int32_t queued_position;      // Position once every queued segment is done
+   int8_t step_sign;             // Position change per step of the running step segment
+   int8_t queued_sign;           // Direction of the last queued step segment
+   bool homing;
+#if CONFIG_MOTORS_DRV_SENSE
+   struct motors_sense sense;
+   bool sense_ready;
+   uint8_t sense_over_cnt;       // Consecutive batches above the current limit
+   uint32_t sense_over_cyc;      // Cycle count at the first of those batches
+   struct motors_drv_sense_stats sense_stats;
+#endif
 };
 
-struct motors_states_s {
-   bool dc_en;
-   bool step_en;
-};
+#if CONFIG_MOTORS_DRV_SENSE
+static void sense_power_update(const struct device *dev, const bool on)
+{
+   struct motors_drv_data *data = dev->data;
 
+   // Sample only while the supply is up, the SAADC draws current while running
+   if (!data->sense_ready) {
+      return;
+   }
+   if (on)
+   {
+      data->sense_over_cnt = 0;
+      (void)motors_sense_start(&data->sense);
+   }
+   else {
+      motors_sense_stop(&data->sense);
+   }
+}
+#endif
 
-static struct motors_states_s motors_states = { 
-   .dc_en = false, 
-   .step_en = false,
-};
-static struct k_timer timer_step_motor;
-static struct gpio_dt_spec step_gpio, nsleep_gpio, en_gpio;
-static volatile bool step_toggle;
-static volatile uint32_t step_toggle_cnt, step_toggle_cnt_max;
+static void pwr_off(const struct device *dev)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
 
+   // Called with pwr_lock held
+   gpio_pin_set_dt(&cfg->nsleep_gpio, 0);
+   gpio_pin_set_dt(&cfg->en_gpio, 0);
+#if CONFIG_MOTORS_DRV_SENSE
+   sense_power_update(dev, false);
+#endif
+   data->pwr_on_ms += k_uptime_get() - data->pwr_on_since;
+   data->pwr_state = MOTORS_DRV_PWR_OFF;
+}
 
-static void timer_step_motor_cb(struct k_timer *timer)
+static void pwr_idle(const struct device *dev)
 {
-   // TODO: use GPIOTE + PPI to generate pulse signal
-   if (step_toggle) {
-      gpio_pin_set_dt(&step_gpio, 1);
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   // Called with pwr_lock held, stay powered for a while in case another move follows
+   if (cfg->pwr_idle_ms == 0)
+   {
+      pwr_off(dev);
+      return;
    }
-   else
+   data->pwr_state = MOTORS_DRV_PWR_IDLE;
+   k_timer_start(&data->pwr_idle_timer, K_MSEC(cfg->pwr_idle_ms), K_NO_WAIT);
+}
+
+static bool pwr_get(const struct device *dev, const uint8_t user)
+{
+   bool ready;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   data->pwr_users |= user;
+   switch (data->pwr_state)
    {
-      gpio_pin_set_dt(&step_gpio, 0);
-      step_toggle_cnt++;
-      if (step_toggle_cnt >= step_toggle_cnt_max)
+   case MOTORS_DRV_PWR_OFF:
+      gpio_pin_set_dt(&cfg->nsleep_gpio, 1);
+      gpio_pin_set_dt(&cfg->en_gpio, 1);
+      data->pwr_on_since = k_uptime_get();
+      data->pwr_wake_cnt++;
+#if CONFIG_MOTORS_DRV_SENSE
+      sense_power_update(dev, true);
+#endif
+      if (cfg->pwr_settle_us > 0)
       {
-         // We're done! Stop timer and power down motors if we can
-         k_timer_stop(&timer_step_motor);
-         motors_states.step_en = false;
-         if (motors_states.dc_en == 0)
-         {
-            gpio_pin_configure_dt(&nsleep_gpio, GPIO_OUTPUT_LOW);
-            gpio_pin_configure_dt(&en_gpio, GPIO_OUTPUT_LOW);
-         }
+         data->pwr_state = MOTORS_DRV_PWR_WAKING;
+         k_timer_start(&data->pwr_settle_timer, K_USEC(cfg->pwr_settle_us), K_NO_WAIT);
       }
+      else {
+         data->pwr_state = MOTORS_DRV_PWR_ON;
+      }
+      break;
+   case MOTORS_DRV_PWR_IDLE:
+      k_timer_stop(&data->pwr_idle_timer);
+      data->pwr_state = MOTORS_DRV_PWR_ON;
+      break;
+   default:
+      break;
    }
-   step_toggle = !step_toggle;
+   ready = (data->pwr_state == MOTORS_DRV_PWR_ON);
+   k_spin_unlock(&data->pwr_lock, key);
+
+   return ready;
 }
 
-static int32_t move_step(const struct device *dev, const uint8_t dir, const uint32_t n_steps)
+static void pwr_put(const struct device *dev, const uint8_t user)
+{
+   struct motors_drv_data *data = dev->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   data->pwr_users &= ~user;
+   if ((data->pwr_users == 0) && (data->pwr_state == MOTORS_DRV_PWR_ON)) {
+      pwr_idle(dev);
+   }
+   k_spin_unlock(&data->pwr_lock, key);
+}
+
+static void pwr_idle_expiry(struct k_timer *timer)
 {
+   struct motors_drv_data *data = CONTAINER_OF(timer, struct motors_drv_data, pwr_idle_timer);
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   if ((data->pwr_state == MOTORS_DRV_PWR_IDLE) && (data->pwr_users == 0)) {
+      pwr_off(data->dev);
+   }
+   k_spin_unlock(&data->pwr_lock, key);
+}
+
+static int32_t step_pulse_start(const struct device *dev)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
    const struct motors_drv_config *cfg = dev->config;
+   const struct motors_drv_segment *seg = &data->seg_active;
 
-   // TODO: put some limit on n_steps
+   // Called with seg_lock held, hand the pulse train to the pulse engine. Only registers are
+   // written, callers log failures once the lock is released
+   if (seg->type == MOTORS_DRV_SEG_STEP_PROFILE) {
+      ret = motors_pulse_start_ramp(&data->pulse, seg->n_steps, data->ramp_us, 
+         data->ramp_len, data->ramp_cruise_us);
+   }
+   else {
+      ret = motors_pulse_start(&data->pulse, seg->n_steps, MOTORS_STEP_PULSE_PERIOD_US(cfg));
+   }
+   // Until then the engine still counts the previous train
+   data->step_armed = (ret == 0);
 
-   // Set direction pin and lift !RST pin
-   switch (dir)
+   return ret;
+}
+
+static void step_pwr_release(const struct device *dev)
+{
+   struct motors_drv_data *data = dev->data;
+
+   // Called with seg_lock held, release the supply once no step segment is using it any 
+   // more. A step segment that is starting holds seg_running before taking the supply
+   if ((data->seg_running && (data->seg_active.type != MOTORS_DRV_SEG_DC)) || 
+         data->pulse.busy || data->step_pending) {
+      return;
+   }
+   pwr_put(dev, MOTORS_PWR_USER_STEP);
+}
+
+static int32_t step_start(const struct device *dev, const struct motors_drv_segment *seg, 
+   atomic_val_t gen)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   if (atomic_get(&data->seg_gen) != gen)
    {
-   case MOTOR_DIR_FORWARD:
-      gpio_pin_set_dt(&cfg->step_dir_gpio, 0);
+      // Stopped while starting, the stop already ended the segment
+      k_spin_unlock(&data->seg_lock, key);
+      return -ECANCELED;
+   }
+   if (seg->dir != MOTOR_DIR_NULL) {
+      gpio_pin_set_dt(&cfg->step_dir_gpio, (seg->dir == MOTOR_DIR_BACKWARD) ? 1 : 0);
+   }
+   // The supply reference is taken under seg_lock, where step_pwr_release() drops it, and 
+   // the supply state is read under pwr_lock. Steps sent before the drivers are out of 
+   // sleep are lost, the supply settle timer sends them once it is up (it takes seg_lock 
+   // after setting the state)
+   if (pwr_get(dev, MOTORS_PWR_USER_STEP)) {
+      ret = step_pulse_start(dev);
+   }
+   else {
+      data->step_pending = true;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   return ret;
+}
+
+static int32_t seg_dc_start(const struct device *dev, const struct motors_drv_segment *seg, 
+   atomic_val_t gen);
+
+static void seg_notify(const struct device *dev, const struct motors_drv_segment *seg, 
+   int32_t result)
+{
+   struct motors_drv_data *data = dev->data;
+
+   if (seg->type == MOTORS_DRV_SEG_STEP_PROFILE) {
+      atomic_dec(&data->seg_profile_cnt);
+   }
+   if (seg->signal != NULL) {
+      k_poll_signal_raise(seg->signal, result);
+   }
+   if (seg->cb != NULL) {
+      seg->cb(dev, seg, result);
+   }
+}
+
+static int32_t seg_start(const struct device *dev, const struct motors_drv_segment *seg, 
+   atomic_val_t gen)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+
+   // Called without seg_lock. Returns 0 if the segment completes later, 1 if it already 
+   // completed, -ECANCELED if it was stopped (seg_gen changed) before reaching the hardware
+   switch (seg->type)
+   {
+   case MOTORS_DRV_SEG_STEP:
+   case MOTORS_DRV_SEG_STEP_PROFILE:
+      if (seg->n_steps == 0) {
+         return 1;
+      }
+      return step_start(dev, seg, gen);
+   case MOTORS_DRV_SEG_DC:
+      ret = seg_dc_start(dev, seg, gen);
+      if ((ret != 0) || (seg->hold_ms == 0)) {
+         return (ret != 0) ? ret : 1;
+      }
+      k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+      if (atomic_get(&data->seg_gen) == gen) {
+         k_timer_start(&data->dc_hold_timer, K_MSEC(seg->hold_ms), K_NO_WAIT);
+      }
+      else {
+         ret = -ECANCELED;
+      }
+      k_spin_unlock(&data->seg_lock, key);
+      return ret;
+   default:
+      return -EINVAL;
+   }
+}
+
+// Ends the running segment. With gen, only if it is still the segment started with gen
+static void seg_end(const struct device *dev, int32_t result, const atomic_val_t *gen)
+{
+   struct motors_drv_data *data = dev->data;
+   struct motors_drv_segment seg;
+
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   if (!data->seg_running || ((gen != NULL) && (atomic_get(&data->seg_gen) != *gen)))
+   {
+      k_spin_unlock(&data->seg_lock, key);
+      return;
+   }
+   seg = data->seg_active;
+   data->seg_running = false;
+   atomic_inc(&data->seg_gen);
+   data->seg_completed++;
+   if ((seg.flags & MOTORS_DRV_SEG_F_CHAIN) && (k_msgq_num_used_get(&data->seg_q) == 0)) {
+      data->seg_underruns++;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   seg_notify(dev, &seg, result);
+}
+
+static void seg_finish(const struct device *dev, int32_t result)
+{
+   seg_end(dev, result, NULL);
+}
+
+static void seg_next(const struct device *dev)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   struct motors_drv_segment seg;
+   atomic_val_t gen;
+
+   // Start the next queued segment, finishing right away those that complete on start
+   while (true)
+   {
+      k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+      if (data->seg_running || 
+          (k_msgq_get(&data->seg_q, &data->seg_active, K_NO_WAIT) != 0))
+      {
+         step_pwr_release(dev);
+         k_spin_unlock(&data->seg_lock, key);
+         return;
+      }
+      // Only the bookkeeping is locked, the hardware is started from a copy once released
+      data->seg_running = true;
+      // Only step segments turn the stepper, a DC segment's direction is the DC motor's
+      if (((data->seg_active.type == MOTORS_DRV_SEG_STEP) || 
+          (data->seg_active.type == MOTORS_DRV_SEG_STEP_PROFILE)) && 
+          (data->seg_active.dir != MOTOR_DIR_NULL)) {
+         data->step_sign = (data->seg_active.dir == MOTOR_DIR_FORWARD) ? 1 : -1;
+      }
+      seg = data->seg_active;
+      gen = atomic_get(&data->seg_gen);
+      k_spin_unlock(&data->seg_lock, key);
+
+      ret = seg_start(dev, &seg, gen);
+      if (ret == 0) {
+         return;
+      }
+      // Ended by the stop that cancelled it, move on to whatever is queued now
+      if (ret == -ECANCELED) {
+         continue;
+      }
+      if (ret < 0) {
+         LOG_ERR("Segment type %d failed to start, err %d", (int32_t)seg.type, ret);
+      }
+      seg_end(dev, (ret < 0) ? ret : 0, &gen);
+   }
+}
+
+static void step_pulse_done_cb(const struct device *dev, uint32_t n_pulses)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   LOG_DBG("Stepper move done, %d pulses", (int32_t)n_pulses);
+
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   data->position += data->step_sign * (int32_t)n_pulses;
+   data->step_armed = false;
+   if (data->seg_active.flags & MOTORS_DRV_SEG_F_HOME)
+   {
+      // Sitting against the end stop, this is the reference position from now on
+      data->position = cfg->home_pos;
+      data->queued_position = cfg->home_pos;
+      data->homing = false;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   // Start the next segment before releasing the supply so back-to-back moves keep it on
+   seg_finish(dev, 0);
+   seg_next(dev);
+}
+
+static void pwr_settle_expiry(struct k_timer *timer)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = CONTAINER_OF(timer, struct motors_drv_data, pwr_settle_timer);
+   const struct device *dev = data->dev;
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   if (data->pwr_state == MOTORS_DRV_PWR_WAKING)
+   {
+      data->pwr_state = MOTORS_DRV_PWR_ON;
+      if (data->pwr_users == 0) {
+         pwr_idle(dev);
+      }
+   }
+   k_spin_unlock(&data->pwr_lock, key);
+
+   // Supply is up, send the steps held back while waking
+   key = k_spin_lock(&data->seg_lock);
+   if (data->step_pending)
+   {
+      data->step_pending = false;
+      ret = step_pulse_start(dev);
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   if (ret != 0)
+   {
+      LOG_ERR("Held back step segment failed to start, err %d", ret);
+      seg_finish(dev, ret);
+      seg_next(dev);
+   }
+}
+
+static void dc_hold_expiry(struct k_timer *timer)
+{
+   struct motors_drv_data *data = CONTAINER_OF(timer, struct motors_drv_data, dc_hold_timer);
+
+   seg_finish(data->dev, 0);
+   seg_next(data->dev);
+}
+
+static bool profile_cached(const struct device *dev, const struct motors_drv_profile *profile)
+{
+   struct motors_drv_data *data = dev->data;
+
+   return data->ramp_valid && (memcmp(profile, &data->profile, sizeof(*profile)) == 0);
+}
+
+static int32_t profile_prepare(const struct device *dev, const struct motors_drv_profile *profile)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   // Rebuild the cached ramp table only when the profile changes
+   if (profile_cached(dev, profile)) {
+      return 0;
+   }
+
+   // The pulse engine reads the ramp table while moving, it can only be rebuilt once 
+   // every segment using it is done
+   if (atomic_get(&data->seg_profile_cnt) > 0)
+   {
+      LOG_ERR("Profile in use by queued segments");
+      return -EBUSY;
+   }
+
+   data->ramp_valid = false;
+   ret = motors_profile_build(profile, USEC_PER_SEC / MOTORS_STEP_PULSE_PERIOD_US(cfg),
+      data->ramp_us, ARRAY_SIZE(data->ramp_us), &data->ramp_cruise_us);
+   if (ret < 0)
+   {
+      LOG_ERR("motors_profile_build() failed, err %d", ret);
+      return ret;
+   }
+   data->ramp_len = ret;
+   data->profile = *profile;
+   data->ramp_valid = true;
+
+   return 0;
+}
+
+static int32_t seg_queue(const struct device *dev, const struct motors_drv_segment *seg)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   if (seg->dir > MOTOR_DIR_NULL)
+   {
+      LOG_ERR("Invalid direction param, dir: %d", (int32_t)seg->dir);
+      return -EINVAL;
+   }
+   switch (seg->type)
+   {
+   case MOTORS_DRV_SEG_STEP:
       break;
-   case MOTOR_DIR_BACKWARD:
-      gpio_pin_set_dt(&cfg->step_dir_gpio, 1);
+   case MOTORS_DRV_SEG_STEP_PROFILE:
+      // Use the active profile, or the DT default if none was set yet
+      if (!data->ramp_valid)
+      {
+         ret = profile_prepare(dev, &cfg->profile);
+         if (ret != 0) {
+            return ret;
+         }
+      }
+      atomic_inc(&data->seg_profile_cnt);
       break;
-   case MOTOR_DIR_NULL:
+   case MOTORS_DRV_SEG_DC:
+      if (seg->duty_cycle_per > 100)
+      {
+         LOG_ERR("Invalid duty cycle percent value: %d", (int32_t)seg->duty_cycle_per);
+         return -EINVAL;
+      }
       break;
    default:
-      LOG_ERR("Invalid direction param, dir: %d", (int32_t)dir);
+      LOG_ERR("Invalid segment type: %d", (int32_t)seg->type);
       return -EINVAL;
    }
 
-   // Set stepper motor enable flag and turn on motors
-   motors_states.step_en = true;
-   gpio_pin_configure_dt(&nsleep_gpio, GPIO_OUTPUT_HIGH);
-   gpio_pin_configure_dt(&en_gpio, GPIO_OUTPUT_HIGH);
+   // Check the soft limits against the position reached once everything queued is done
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   int8_t sign = data->queued_sign;
+   int64_t target = data->queued_position;
+   if (seg->type != MOTORS_DRV_SEG_DC)
+   {
+      if (seg->dir != MOTOR_DIR_NULL) {
+         sign = (seg->dir == MOTOR_DIR_FORWARD) ? 1 : -1;
+      }
+      target += (int64_t)sign * seg->n_steps;
+   }
+   if (data->homing && !(seg->flags & MOTORS_DRV_SEG_F_HOME)) {
+      ret = -EBUSY;
+   }
+   else if (!(seg->flags & MOTORS_DRV_SEG_F_HOME) && 
+            ((target < cfg->pos_min) || (target > cfg->pos_max))) {
+      ret = -ERANGE;
+   }
+   else if (k_msgq_put(&data->seg_q, seg, K_NO_WAIT) != 0) {
+      ret = -ENOBUFS;
+   }
+   else
+   {
+      data->queued_sign = sign;
+      data->queued_position = (int32_t)target;
+      data->seg_depth_max = MAX(data->seg_depth_max, k_msgq_num_used_get(&data->seg_q));
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   if (ret != 0)
+   {
+      if (seg->type == MOTORS_DRV_SEG_STEP_PROFILE) {
+         atomic_dec(&data->seg_profile_cnt);
+      }
+      LOG_ERR("Unable to queue segment, err %d", ret);
+      return ret;
+   }
+
+   seg_next(dev);
+
+   return 0;
+}
+
+static int32_t queue(const struct device *dev, const struct motors_drv_segment *seg)
+{
+   if (seg->flags & MOTORS_DRV_SEG_F_HOME)
+   {
+      LOG_ERR("Invalid segment flags: 0x%x", (uint32_t)seg->flags);
+      return -EINVAL;
+   }
+
+   return seg_queue(dev, seg);
+}
+
+static void seg_drop_queued(const struct device *dev)
+{
+   struct motors_drv_data *data = dev->data;
+   struct motors_drv_segment seg;
+   k_spinlock_key_t key;
+
+   while (k_msgq_get(&data->seg_q, &seg, K_NO_WAIT) == 0)
+   {
+      key = k_spin_lock(&data->seg_lock);
+      data->seg_completed++;
+      k_spin_unlock(&data->seg_lock, key);
+      seg_notify(dev, &seg, -ECANCELED);
+   }
+
+   // Only the running segment (if any) is left, queued moves now start where it ends
+   key = k_spin_lock(&data->seg_lock);
+   data->queued_position = data->position;
+   data->queued_sign = data->step_sign;
+   if (data->seg_running && (data->seg_active.type != MOTORS_DRV_SEG_DC)) {
+      data->queued_position += data->step_sign * (int32_t)data->seg_active.n_steps;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+}
+
+static int32_t flush(const struct device *dev)
+{
+   struct motors_drv_data *data = dev->data;
+   struct motors_drv_segment seg;
+   bool was_running;
+
+   // Stop the running segment
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   was_running = data->seg_running;
+   seg = data->seg_active;
+   if (was_running)
+   {
+      if (seg.type == MOTORS_DRV_SEG_DC) {
+         k_timer_stop(&data->dc_hold_timer);
+      }
+      else if (data->step_armed) {
+         data->position += data->step_sign * (int32_t)motors_pulse_stop(&data->pulse);
+         data->step_armed = false;
+      }
+      else {
+         data->step_pending = false;
+      }
+      data->seg_running = false;
+      atomic_inc(&data->seg_gen);
+      data->seg_completed++;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   if (was_running) {
+      seg_notify(dev, &seg, -ECANCELED);
+   }
+
+   // Drop everything still queued, the stepper stays where it stopped
+   seg_drop_queued(dev);
+   key = k_spin_lock(&data->seg_lock);
+   data->homing = false;
+   step_pwr_release(dev);
+   k_spin_unlock(&data->seg_lock, key);
+
+   return 0;
+}
+
+static int32_t get_pwr_stats(const struct device *dev, struct motors_drv_pwr_stats *stats)
+{
+   struct motors_drv_data *data = dev->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   stats->state = data->pwr_state;
+   stats->users = data->pwr_users;
+   stats->wake_cnt = data->pwr_wake_cnt;
+   stats->on_ms = data->pwr_on_ms;
+   if (data->pwr_state != MOTORS_DRV_PWR_OFF) {
+      stats->on_ms += k_uptime_get() - data->pwr_on_since;
+   }
+   stats->uptime_ms = k_uptime_get();
+   k_spin_unlock(&data->pwr_lock, key);
+
+   return 0;
+}
+
+static int32_t get_queue_stats(const struct device *dev, struct motors_drv_queue_stats *stats)
+{
+   struct motors_drv_data *data = dev->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   stats->depth = k_msgq_num_used_get(&data->seg_q);
+   stats->depth_max = data->seg_depth_max;
+   stats->completed = data->seg_completed;
+   stats->underruns = data->seg_underruns;
+   stats->active = data->seg_running;
+   k_spin_unlock(&data->seg_lock, key);
+
+   return 0;
+}
+
+static int32_t move_step(const struct device *dev, const uint8_t dir, const uint32_t n_steps)
+{
+   const struct motors_drv_segment seg = {
+      .type = MOTORS_DRV_SEG_STEP,
+      .dir = dir,
+      .n_steps = n_steps,
+   };
+
+   return queue(dev, &seg);
+}
+
+static int32_t move_step_profile(const struct device *dev, const uint8_t dir, 
+   const uint32_t n_steps, const struct motors_drv_profile *profile)
+{
+   int32_t ret = 0;
+   const struct motors_drv_config *cfg = dev->config;
+   const struct motors_drv_segment seg = {
+      .type = MOTORS_DRV_SEG_STEP_PROFILE,
+      .dir = dir,
+      .n_steps = n_steps,
+   };
+
+   ret = profile_prepare(dev, (profile != NULL) ? profile : &cfg->profile);
+   if (ret != 0) {
+      return ret;
+   }
+
+   return queue(dev, &seg);
+}
+
+static int32_t move_to(const struct device *dev, const int32_t position)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+   int64_t delta;
+
+   if ((position < cfg->pos_min) || (position > cfg->pos_max))
+   {
+      LOG_ERR("Position %d out of soft limits [%d, %d]", position, cfg->pos_min, cfg->pos_max);
+      return -ERANGE;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   delta = (int64_t)position - data->queued_position;
+   k_spin_unlock(&data->seg_lock, key);
+
+   if (delta == 0) {
+      return 0;
+   }
+
+   return move_step_profile(dev, (delta > 0) ? MOTOR_DIR_FORWARD : MOTOR_DIR_BACKWARD, 
+      (uint32_t)((delta > 0) ? delta : -delta), NULL);
+}
+
+static int32_t get_position(const struct device *dev, int32_t *position)
+{
+   struct motors_drv_data *data = dev->data;
 
-   // Set step pulse period and start timer
-   step_toggle_cnt = 0;
-   step_toggle_cnt_max = n_steps * 2;
-   k_timer_start(&timer_step_motor, K_USEC(cfg->step_period_us), K_USEC(cfg->step_period_us));
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   *position = data->position;
+   // Only once the train is armed, before that (supply settling, segment just dequeued) the
+   // engine still returns the count of the previous train. A train that just finished is
+   // still counted here until its done callback adds it to the position
+   if (data->step_armed) {
+      *position += data->step_sign * (int32_t)motors_pulse_get_count(&data->pulse);
+   }
+   k_spin_unlock(&data->seg_lock, key);
 
    return 0;
 }
 
-static int32_t set_dc_pwm(const struct device *dev, const float duty_cycle)
+static int32_t home(const struct device *dev)
 {
    int32_t ret = 0;
    struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+   const struct motors_drv_segment seg = {
+      .type = MOTORS_DRV_SEG_STEP,
+      .dir = MOTOR_DIR_BACKWARD,
+      .flags = MOTORS_DRV_SEG_F_HOME,
+      .n_steps = cfg->home_steps,
+   };
+
+   if (cfg->home_steps == 0)
+   {
+      LOG_ERR("Homing not configured, set 'step-home-steps'");
+      return -ENOTSUP;
+   }
+
+   // Drive toward the end stop for more than the full travel, steps past it are lost
+   ret = flush(dev);
+   if (ret != 0) {
+      return ret;
+   }
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   data->homing = true;
+   k_spin_unlock(&data->seg_lock, key);
+
+   return seg_queue(dev, &seg);
+}
+
+static int32_t set_dc_pwm(const struct device *dev, const uint16_t duty_permille)
+{
+   int32_t ret = 0;
+   const struct motors_drv_config *cfg = dev->config;
 
    // Ensure correct duty cycle value
-   if (duty_cycle < 0.0f || duty_cycle > 1.0f)
+   if (duty_permille > MOTORS_DC_DUTY_MAX)
    {
-      LOG_ERR("Invalid duty cycle value: %f", duty_cycle);
+      LOG_ERR("Invalid duty cycle value: %d", (int32_t)duty_permille);
       return -EINVAL;
    }
 
    // Set the PWM duty cycle
-   ret = pwm_set_pulse_dt(&data->dc_en_pwm, data->dc_en_pwm.period * duty_cycle);
+   ret = pwm_set_pulse_dt(&cfg->dc_en_pwm, MOTORS_DC_PULSE(cfg, duty_permille));
    if (ret != 0)
    {
       LOG_ERR("pwm_set_pulse_dt() failed, err %d", ret);
@@ -144,26 +866,102 @@ static int32_t set_dc_pwm(const struct device *dev, const float duty_cycle)
    return 0;
 }
 
-static int32_t move_dc(const struct device *dev, const uint8_t dir, const uint8_t duty_cycle_per)
+static int32_t dc_apply(const struct device *dev, const int32_t duty_pm)
 {
    int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+   uint32_t duty_abs = (duty_pm < 0) ? -duty_pm : duty_pm;
+
+   // Direction only changes at zero duty, ramps always pass through it
+   if (duty_pm > 0) {
+      gpio_pin_set_dt(&cfg->dc_ph_gpio, 1);
+   }
+   else if (duty_pm < 0) {
+      gpio_pin_set_dt(&cfg->dc_ph_gpio, 0);
+   }
+
+   ret = pwm_set_pulse_dt(&cfg->dc_en_pwm, MOTORS_DC_PULSE(cfg, duty_abs));
+   if (ret != 0)
+   {
+      LOG_ERR("pwm_set_pulse_dt() failed, err %d", ret);
+      return ret;
+   }
+   data->dc_cur = duty_pm;
+
+   return 0;
+}
+
+static void dc_power_update(const struct device *dev, const bool on)
+{
+   if (on) {
+      (void)pwr_get(dev, MOTORS_PWR_USER_DC);
+   }
+   else {
+      pwr_put(dev, MOTORS_PWR_USER_DC);
+   }
+}
+
+static void dc_ramp_expiry(struct k_timer *timer)
+{
+   struct motors_drv_data *data = CONTAINER_OF(timer, struct motors_drv_data, dc_ramp_timer);
+   const struct device *dev = data->dev;
    const struct motors_drv_config *cfg = dev->config;
+   int32_t cur, tgt, step, next;
+
+   k_spinlock_key_t key = k_spin_lock(&data->dc_lock);
+   cur = data->dc_cur;
+   tgt = data->dc_target;
+
+   // Slowing down (or reversing) uses the brake slew, speeding up the accel slew
+   if (((cur > 0) && (tgt < cur)) || ((cur < 0) && (tgt > cur))) {
+      step = cfg->dc_brake_slew * MOTORS_DC_RAMP_TICK_MS;
+   }
+   else {
+      step = cfg->dc_accel_slew * MOTORS_DC_RAMP_TICK_MS;
+   }
+   if ((step == 0) || (abs(tgt - cur) <= step)) {
+      next = tgt;
+   }
+   else {
+      next = (tgt > cur) ? (cur + step) : (cur - step);
+   }
+
+   // Stop at zero before reversing so the other direction starts with the accel slew
+   if (((cur > 0) && (next < 0)) || ((cur < 0) && (next > 0))) {
+      next = 0;
+   }
+   (void)dc_apply(dev, next);
+   if (next == tgt)
+   {
+      k_timer_stop(&data->dc_ramp_timer);
+      data->dc_ramping = false;
+      if (next == 0) {
+         dc_power_update(dev, false);
+      }
+   }
+   k_spin_unlock(&data->dc_lock, key);
+}
+
+static int32_t dc_target_get(const struct device *dev, const uint8_t dir, 
+   const uint8_t duty_cycle_per, int32_t *duty_pm)
+{
+   struct motors_drv_data *data = dev->data;
 
    // Ensure correct duty cycle percent value
-   if (duty_cycle_per < 0 || duty_cycle_per > 100)
+   if (duty_cycle_per > 100)
    {
       LOG_ERR("Invalid duty cycle percent value: %d", (int32_t)duty_cycle_per);
       return -EINVAL;
    }
 
-   // Set direction pin
    switch (dir)
    {
    case MOTOR_DIR_FORWARD:
-      gpio_pin_configure_dt(&cfg->dc_ph_gpio, GPIO_OUTPUT_HIGH);
+      data->dc_sign = 1;
       break;
    case MOTOR_DIR_BACKWARD:
-      gpio_pin_configure_dt(&cfg->dc_ph_gpio, GPIO_OUTPUT_LOW);
+      data->dc_sign = -1;
       break;
    case MOTOR_DIR_NULL:
       break;
@@ -172,33 +970,321 @@ static int32_t move_dc(const struct device *dev, const uint8_t dir, const uint8_
       return -EINVAL;
    }
 
-   // Set PWM duty cycle
-   float duty_cycle = ((float)duty_cycle_per) / 100.0;
-   ret = set_dc_pwm(dev, duty_cycle);
-   if (ret != 0)
+   *duty_pm = data->dc_sign * (int32_t)duty_cycle_per * (MOTORS_DC_DUTY_MAX / 100);
+
+   return 0;
+}
+
+static int32_t move_dc_immediate(const struct device *dev, const uint8_t dir, 
+   const uint8_t duty_cycle_per)
+{
+   int32_t ret = 0;
+   int32_t duty_pm;
+   struct motors_drv_data *data = dev->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->dc_lock);
+   ret = dc_target_get(dev, dir, duty_cycle_per, &duty_pm);
+   if (ret == 0)
    {
-      LOG_ERR("set_dc_pwm() failed, err %d", ret);
-      return ret;
+      // Cancel any ramp in progress and jump straight to the duty cycle
+      k_timer_stop(&data->dc_ramp_timer);
+      data->dc_ramping = false;
+      data->dc_target = duty_pm;
+      ret = dc_apply(dev, duty_pm);
+      dc_power_update(dev, (duty_pm != 0));
+   }
+   k_spin_unlock(&data->dc_lock, key);
+
+   return ret;
+}
+
+static int32_t dc_ramp_to(const struct device *dev, const int32_t duty_pm)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   // Called with dc_lock held
+   if ((cfg->dc_accel_slew == 0) && (cfg->dc_brake_slew == 0))
+   {
+      data->dc_target = duty_pm;
+      dc_power_update(dev, (duty_pm != 0));
+      return dc_apply(dev, duty_pm);
    }
 
-   // Turn on DC motor or turn off all motors if we can
-   if (duty_cycle_per > 0)
+   if (duty_pm != data->dc_target)
    {
-      motors_states.dc_en = true;
-      gpio_pin_configure_dt(&nsleep_gpio, GPIO_OUTPUT_HIGH);
-      gpio_pin_configure_dt(&en_gpio, GPIO_OUTPUT_HIGH);
+      // Power up before the ramp starts, the ramp powers down once it settles at zero
+      data->dc_target = duty_pm;
+      if (duty_pm != 0) {
+         dc_power_update(dev, true);
+      }
+      if (!data->dc_ramping)
+      {
+         data->dc_ramping = true;
+         k_timer_start(&data->dc_ramp_timer, K_NO_WAIT, K_MSEC(MOTORS_DC_RAMP_TICK_MS));
+      }
+   }
+
+   return 0;
+}
+
+static int32_t move_dc(const struct device *dev, const uint8_t dir, const uint8_t duty_cycle_per)
+{
+   int32_t ret = 0;
+   int32_t duty_pm;
+   struct motors_drv_data *data = dev->data;
+
+   k_spinlock_key_t key = k_spin_lock(&data->dc_lock);
+   ret = dc_target_get(dev, dir, duty_cycle_per, &duty_pm);
+   if (ret == 0) {
+      ret = dc_ramp_to(dev, duty_pm);
+   }
+   k_spin_unlock(&data->dc_lock, key);
+
+   return ret;
+}
+
+static int32_t seg_dc_start(const struct device *dev, const struct motors_drv_segment *seg, 
+   atomic_val_t gen)
+{
+   int32_t ret = 0;
+   int32_t duty_pm;
+   struct motors_drv_data *data = dev->data;
+
+   // A stop since the segment was dequeued must stick, the duty cycle is only applied if
+   // the segment is still running. A stop after this check comes with its own duty cycle
+   k_spinlock_key_t key = k_spin_lock(&data->dc_lock);
+   if (atomic_get(&data->seg_gen) != gen) {
+      ret = -ECANCELED;
    }
    else
    {
-      motors_states.dc_en = false;
-      if (motors_states.step_en == 0) {
-         gpio_pin_configure_dt(&nsleep_gpio, GPIO_OUTPUT_LOW);
-         gpio_pin_configure_dt(&en_gpio, GPIO_OUTPUT_LOW);
+      ret = dc_target_get(dev, seg->dir, seg->duty_cycle_per, &duty_pm);
+      if (ret == 0) {
+         ret = dc_ramp_to(dev, duty_pm);
+      }
+   }
+   k_spin_unlock(&data->dc_lock, key);
+
+   return ret;
+}
+
+static int32_t drive(const struct device *dev, const int16_t throttle_permille, 
+   const int32_t steering_pos)
+{
+   int32_t ret = 0;
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+
+   // Validate both targets before touching either motor
+   if ((throttle_permille < -MOTORS_DC_DUTY_MAX) || (throttle_permille > MOTORS_DC_DUTY_MAX))
+   {
+      LOG_ERR("Invalid throttle value: %d", (int32_t)throttle_permille);
+      return -EINVAL;
+   }
+   if ((steering_pos < cfg->pos_min) || (steering_pos > cfg->pos_max))
+   {
+      LOG_ERR("Steering position %d out of soft limits [%d, %d]", steering_pos, 
+         cfg->pos_min, cfg->pos_max);
+      return -ERANGE;
+   }
+
+   // Homing owns the stepper until it is done, its queued segment must not be dropped
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   bool homing = data->homing;
+   k_spin_unlock(&data->seg_lock, key);
+   if (homing) {
+      return -EBUSY;
+   }
+
+   // Steering moves use the DT profile. A rebuild of the ramp table takes a while, it is
+   // done before the scheduler is locked (queued moves of another profile are dropped 
+   // first, they would be below anyway) so that move_to() only queues the segment
+   if (!profile_cached(dev, &cfg->profile))
+   {
+      seg_drop_queued(dev);
+      ret = profile_prepare(dev, &cfg->profile);
+      if (ret != 0) {
+         return ret;
+      }
+   }
+
+   // Apply both without being preempted by other threads. Steering retargets from the 
+   // running move, older queued moves are dropped so it never lags behind
+   k_sched_lock();
+   seg_drop_queued(dev);
+   ret = move_to(dev, steering_pos);
+   if (ret == 0)
+   {
+      key = k_spin_lock(&data->dc_lock);
+      if (throttle_permille != 0) {
+         data->dc_sign = (throttle_permille > 0) ? 1 : -1;
       }
+      ret = dc_ramp_to(dev, throttle_permille);
+      k_spin_unlock(&data->dc_lock, key);
    }
+   k_sched_unlock();
+
+   return ret;
+}
+
+static int32_t stop(const struct device *dev)
+{
+   int32_t ret = 0;
 
+   // ISR safe, nothing in here waits
+   ret = flush(dev);
+   if (ret != 0) {
+      return ret;
+   }
+
+   return move_dc_immediate(dev, MOTOR_DIR_NULL, 0);
+}
+
+#if CONFIG_MOTORS_DRV_SENSE
+static void step_abort(const struct device *dev)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+   bool stopped = false;
+   bool homed = false;
+
+   // Stop the running step segment where it is, the stepper is stalled
+   k_spinlock_key_t key = k_spin_lock(&data->seg_lock);
+   if (data->seg_running && (data->seg_active.type != MOTORS_DRV_SEG_DC) && data->pulse.busy)
+   {
+      data->position += data->step_sign * (int32_t)motors_pulse_stop(&data->pulse);
+      data->step_armed = false;
+      if (data->seg_active.flags & MOTORS_DRV_SEG_F_HOME)
+      {
+         // Stalled against the end stop before the full homing travel, that is home too
+         data->position = cfg->home_pos;
+         data->queued_position = cfg->home_pos;
+         data->homing = false;
+         homed = true;
+      }
+      stopped = true;
+   }
+   k_spin_unlock(&data->seg_lock, key);
+
+   if (!stopped) {
+      return;
+   }
+
+   // Moves queued behind a failed one were planned from a position it never reached
+   seg_finish(dev, homed ? 0 : -EIO);
+   if (!homed) {
+      seg_drop_queued(dev);
+   }
+   seg_next(dev);
+}
+
+static void sense_batch_cb(const struct device *dev, uint32_t mean_ma, uint32_t max_ma)
+{
+   struct motors_drv_data *data = dev->data;
+   const struct motors_drv_config *cfg = dev->config;
+   struct motors_drv_sense_stats *stats = &data->sense_stats;
+   uint32_t now = k_cycle_get_32();
+   uint32_t limit = 0;
+   uint32_t abort_us;
+   uint8_t users;
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   stats->batches++;
+   stats->mean_ma = mean_ma;
+   stats->max_ma = max_ma;
+   stats->peak_ma = MAX(stats->peak_ma, max_ma);
+   users = data->pwr_users;
+   k_spin_unlock(&data->pwr_lock, key);
+
+   // A single sense input sees the whole supply, the limit is the sum of the running 
+   // motors. A limit of 0 disables the check while that motor runs
+   if (users & MOTORS_PWR_USER_DC) {
+      limit = (cfg->sense_dc_max_ma > 0) ? (limit + cfg->sense_dc_max_ma) : UINT32_MAX;
+   }
+   if ((users & MOTORS_PWR_USER_STEP) && (limit != UINT32_MAX)) {
+      limit = (cfg->sense_step_max_ma > 0) ? (limit + cfg->sense_step_max_ma) : UINT32_MAX;
+   }
+   if ((limit == 0) || (limit == UINT32_MAX) || (mean_ma <= limit))
+   {
+      data->sense_over_cnt = 0;
+      return;
+   }
+
+   // Start-up and reversal spikes last a batch or so, only a sustained draw is a fault
+   if (data->sense_over_cnt == 0) {
+      data->sense_over_cyc = now;
+   }
+   data->sense_over_cnt++;
+   if (data->sense_over_cnt < CONFIG_MOTORS_DRV_SENSE_DEBOUNCE) {
+      return;
+   }
+   data->sense_over_cnt = 0;
+
+   if (users & MOTORS_PWR_USER_DC)
+   {
+      // No telling which motor draws it, stop everything
+      LOG_WRN("Motors over-current, %d mA", (int32_t)mean_ma);
+      (void)stop(dev);
+   }
+   else
+   {
+      LOG_WRN("Stepper stall, %d mA", (int32_t)mean_ma);
+      step_abort(dev);
+   }
+   // Includes the debounce batches, the fault was first seen in the oldest of them
+   abort_us = k_cyc_to_us_ceil32(k_cycle_get_32() - data->sense_over_cyc);
+
+   key = k_spin_lock(&data->pwr_lock);
+   if (users & MOTORS_PWR_USER_DC) {
+      stats->overcurrents++;
+   }
+   else {
+      stats->stalls++;
+   }
+   stats->abort_us_max = MAX(stats->abort_us_max, abort_us);
+   k_spin_unlock(&data->pwr_lock, key);
+}
+#endif
+
+static int32_t get_sense_stats(const struct device *dev, struct motors_drv_sense_stats *stats)
+{
+#if CONFIG_MOTORS_DRV_SENSE
+   struct motors_drv_data *data = dev->data;
+
+   if (!data->sense_ready) {
+      return -ENOTSUP;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&data->pwr_lock);
+   *stats = data->sense_stats;
+   k_spin_unlock(&data->pwr_lock, key);
 
    return 0;
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(stats);
+
+   return -ENOTSUP;
+#endif
+}
+
+static int32_t get_step_stats(const struct device *dev, struct motors_drv_step_stats *stats, 
+   const bool reset)
+{
+#if CONFIG_MOTORS_DRV_STATS
+   struct motors_drv_data *data = dev->data;
+
+   motors_pulse_get_stats(&data->pulse, stats, reset);
+
+   return 0;
+#else
+   ARG_UNUSED(dev);
+   ARG_UNUSED(stats);
+   ARG_UNUSED(reset);
+
+   return -ENOTSUP;
+#endif
 }
 
 static int32_t motors_drv_init(const struct device *dev)
@@ -209,7 +1295,7 @@ static int32_t motors_drv_init(const struct device *dev)
    data->dev = dev;
 
    // Enable PWM
-   if (!device_is_ready(data->dc_en_pwm.dev))
+   if (!device_is_ready(cfg->dc_en_pwm.dev))
    {
 		LOG_ERR("PWM device is not ready");
 		return -EINVAL;
@@ -221,7 +1307,6 @@ static int32_t motors_drv_init(const struct device *dev)
       LOG_ERR("GPIO device %s is not ready", cfg->nsleep_gpio.port->name);
       return -EINVAL;
    }
-   nsleep_gpio = cfg->nsleep_gpio;
    ret = gpio_pin_configure_dt(&cfg->nsleep_gpio, GPIO_OUTPUT_LOW);
    if (ret != 0)
    {
@@ -235,7 +1320,6 @@ static int32_t motors_drv_init(const struct device *dev)
       LOG_ERR("GPIO device %s is not ready", cfg->en_gpio.port->name);
       return -EINVAL;
    }
-   en_gpio = cfg->en_gpio;
    ret = gpio_pin_configure_dt(&cfg->en_gpio, GPIO_OUTPUT_LOW);
    if (ret != 0)
    {
@@ -261,7 +1345,6 @@ static int32_t motors_drv_init(const struct device *dev)
       LOG_ERR("Unable to configure step_step_gpio pin");
       return ret;
    }
-   step_gpio = cfg->step_step_gpio;
    ret = gpio_pin_configure_dt(&cfg->step_dir_gpio, GPIO_OUTPUT_LOW);
    if (ret != 0)
    {
@@ -276,15 +1359,46 @@ static int32_t motors_drv_init(const struct device *dev)
    }
 
    // Power off all motors at the beginning
-   ret = move_dc(dev, MOTOR_DIR_FORWARD, 0);
+   k_timer_init(&data->pwr_settle_timer, pwr_settle_expiry, NULL);
+   k_timer_init(&data->pwr_idle_timer, pwr_idle_expiry, NULL);
+   data->pwr_state = MOTORS_DRV_PWR_OFF;
+   k_timer_init(&data->dc_ramp_timer, dc_ramp_expiry, NULL);
+   data->dc_sign = 1;
+   ret = move_dc_immediate(dev, MOTOR_DIR_FORWARD, 0);
+   if (ret != 0)
+   {
+      LOG_ERR("move_dc_immediate() failed, err %d", ret);
+      return ret;
+   }
+
+   // Init motion segment queue
+   k_msgq_init(&data->seg_q, data->seg_q_buf, sizeof(struct motors_drv_segment), 
+      CONFIG_MOTORS_DRV_QUEUE_DEPTH);
+   k_timer_init(&data->dc_hold_timer, dc_hold_expiry, NULL);
+   data->step_sign = 1;       // DIR pin is configured low (forward)
+   data->queued_sign = 1;
+
+   // Init pulse engine for stepper motor
+   ret = motors_pulse_init(&data->pulse, dev, &cfg->pulse_cfg, step_pulse_done_cb);
    if (ret != 0)
    {
-      LOG_ERR("move_dc() failed, err %d", ret);
+      LOG_ERR("motors_pulse_init() failed, err %d", ret);
       return ret;
    }
 
-   // Init timer for stepper motor
-   k_timer_init(&timer_step_motor, timer_step_motor_cb, NULL);
+#if CONFIG_MOTORS_DRV_SENSE
+   // Init supply current sensing, motors run unsupervised without a sense input
+   if (cfg->sense_cfg.ain != MOTORS_SENSE_AIN_NONE)
+   {
+      ret = motors_sense_init(&data->sense, dev, &cfg->sense_cfg, sense_batch_cb);
+      if (ret != 0)
+      {
+         LOG_ERR("motors_sense_init() failed, err %d", ret);
+         return ret;
+      }
+      data->sense_ready = true;
+   }
+#endif
 
    LOG_INF("Motors driver successfully initialized");
 
@@ -295,31 +1409,73 @@ static int32_t motors_drv_init(const struct device *dev)
 static const struct motors_drv_api drv_api = {
    .set_dc_pwm = set_dc_pwm,
    .move_dc    = move_dc,
+   .move_dc_immediate = move_dc_immediate,
    .move_step  = move_step,
+   .move_step_profile = move_step_profile,
+   .queue      = queue,
+   .flush      = flush,
+   .get_queue_stats = get_queue_stats,
+   .move_to    = move_to,
+   .get_position = get_position,
+   .home       = home,
+   .drive      = drive,
+   .stop       = stop,
+   .get_pwr_stats = get_pwr_stats,
+   .get_sense_stats = get_sense_stats,
+   .get_step_stats = get_step_stats,
 };
 
 
-// Driver instantiation macro
-#define MOTORS_DRV_DEFINE(inst)                                               \
+// Driver instantiation macro, one device per child node of each 'juskim,motors' node
+#define MOTORS_DRV_DEFINE(node_id)                                            \
                                                                               \
-   static struct motors_drv_data motors_drv_data##inst = {                    \
-      .dc_en_pwm = PWM_DT_SPEC_GET(DT_ALIAS(motors0)),                        \
-   };                                                                         \
+   static struct motors_drv_data _CONCAT(motors_drv_data_, DT_DEP_ORD(node_id)); \
                                                                               \
-   static const struct motors_drv_config motors_drv_config##inst = {          \
-      .nsleep_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), nsleep_gpios),       \
-      .en_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), en_gpios),       \
-      .dc_ph_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), dc_ph_gpios),         \
-      .step_step_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), step_step_gpios), \
-      .step_dir_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), step_dir_gpios),   \
-      .step_nrst_gpio = GPIO_DT_SPEC_GET(DT_ALIAS(motors0), step_nrst_gpios), \
-      .step_period_us = DT_PROP(DT_ALIAS(motors0), step_period_us),           \
+   static const struct motors_drv_config                                      \
+      _CONCAT(motors_drv_config_, DT_DEP_ORD(node_id)) = {                    \
+      .dc_en_pwm = PWM_DT_SPEC_GET(node_id),                                  \
+      .nsleep_gpio = GPIO_DT_SPEC_GET(node_id, nsleep_gpios),                 \
+      .en_gpio = GPIO_DT_SPEC_GET(node_id, en_gpios),                         \
+      .dc_ph_gpio = GPIO_DT_SPEC_GET(node_id, dc_ph_gpios),                   \
+      .step_step_gpio = GPIO_DT_SPEC_GET(node_id, step_step_gpios),           \
+      .step_dir_gpio = GPIO_DT_SPEC_GET(node_id, step_dir_gpios),             \
+      .step_nrst_gpio = GPIO_DT_SPEC_GET(node_id, step_nrst_gpios),           \
+      .step_period_us = DT_PROP(node_id, step_period_us),                     \
+      .pos_min = MOTORS_DT_SOFT_LIMIT(node_id, 0, INT32_MIN),                 \
+      .pos_max = MOTORS_DT_SOFT_LIMIT(node_id, 1, INT32_MAX),                 \
+      .home_steps = DT_PROP(node_id, step_home_steps),                        \
+      .home_pos = DT_PROP(node_id, step_home_pos),                            \
+      .dc_accel_slew = DT_PROP(node_id, dc_accel_slew),                       \
+      .dc_brake_slew = DT_PROP(node_id, dc_brake_slew),                       \
+      .pwr_idle_ms = DT_PROP(node_id, pwr_idle_timeout_ms),                   \
+      .pwr_settle_us = DT_PROP(node_id, pwr_settle_us),                       \
+      .profile = {                                                            \
+         .max_vel = DT_PROP(node_id, step_max_vel),                           \
+         .accel = DT_PROP(node_id, step_accel),                               \
+         .jerk = DT_PROP(node_id, step_jerk),                                 \
+      },                                                                      \
+      .pulse_cfg = {                                                          \
+         .step_gpio = GPIO_DT_SPEC_GET(node_id, step_step_gpios),             \
+         IF_ENABLED(CONFIG_MOTORS_DRV_PULSE_NRFX, (.step_psel =               \
+            NRF_DT_GPIOS_TO_PSEL(node_id, step_step_gpios),))                 \
+      },                                                                      \
+      IF_ENABLED(CONFIG_MOTORS_DRV_SENSE, (                                   \
+      .sense_cfg = {                                                          \
+         .ain = DT_PROP_OR(node_id, sense_ain, MOTORS_SENSE_AIN_NONE),        \
+         .mv_per_a = DT_PROP(node_id, sense_mv_per_a),                        \
+      },                                                                      \
+      .sense_dc_max_ma = DT_PROP(node_id, sense_dc_max_ma),                   \
+      .sense_step_max_ma = DT_PROP(node_id, sense_step_max_ma),))             \
    };                                                                         \
                                                                               \
-   DEVICE_DT_INST_DEFINE(inst,                                                \
-                         motors_drv_init, NULL,                               \
-                         &motors_drv_data##inst, &motors_drv_config##inst,    \
-                         POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,       \
-                         &drv_api);
+   DEVICE_DT_DEFINE(node_id,                                                  \
+                    motors_drv_init, NULL,                                    \
+                    &_CONCAT(motors_drv_data_, DT_DEP_ORD(node_id)),          \
+                    &_CONCAT(motors_drv_config_, DT_DEP_ORD(node_id)),        \
+                    POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,            \
+                    &drv_api);
+
+#define MOTORS_DRV_DEFINE_ALL(inst)                                           \
+   DT_INST_FOREACH_CHILD_STATUS_OKAY(inst, MOTORS_DRV_DEFINE)
 
-DT_INST_FOREACH_STATUS_OKAY(MOTORS_DRV_DEFINE)  // Ignore VS Code error here
+DT_INST_FOREACH_STATUS_OKAY(MOTORS_DRV_DEFINE_ALL)  // Ignore VS Code error here
@@ -19,10 +19,13 @@
 
 
 #define MOTORS_DRV_TOTAL_CMD_W      1
-#define MOTORS_DRV_TOTAL_CMD_MOVE   2
+#define MOTORS_DRV_TOTAL_CMD_MOVE   4
+#define MOTORS_DRV_TOTAL_CMD_QUEUE  3
 
 
-static const struct device *dev_motors_drv = DEVICE_DT_GET_ONE(juskim_motors);
+static const struct device *dev_motors_drv = DEVICE_DT_GET(DT_ALIAS(motors0));
+static struct motors_drv_profile shell_profile;
+static bool shell_profile_set = false;
 
 
 static int32_t cmd_w(const struct shell *sh, size_t argc, char **argv)
@@ -33,7 +36,7 @@ static int32_t cmd_w(const struct shell *sh, size_t argc, char **argv)
    int32_t ret = 0;
 
    char *end;
-   float arg_val = strtof(argv[2], &end);
+   uint32_t arg_val = strtoul(argv[2], &end, 10);
    if (*end != '\0')
    {
       shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
@@ -41,7 +44,7 @@ static int32_t cmd_w(const struct shell *sh, size_t argc, char **argv)
    }
 
    if (strcmp(argv[1], cmd_w_param[0]) == 0) { // pwm
-      ret = motors_drv_set_dc_pwm(dev_motors_drv, arg_val);
+      ret = motors_drv_set_dc_pwm_permille(dev_motors_drv, arg_val);
    }
 
    if (ret != 0)
@@ -56,7 +59,7 @@ static int32_t cmd_w(const struct shell *sh, size_t argc, char **argv)
 static int32_t cmd_move(const struct shell *sh, size_t argc, char **argv)
 {
    const char *cmd_w_param[MOTORS_DRV_TOTAL_CMD_MOVE] = {
-      "dc", "step" };
+      "dc", "step", "prof", "dcnow" };
    ARG_UNUSED(argc);
    int32_t ret = 0;
 
@@ -80,6 +83,13 @@ static int32_t cmd_move(const struct shell *sh, size_t argc, char **argv)
    else if (strcmp(argv[1], cmd_w_param[1]) == 0) { // step
       ret = motors_drv_move_step(dev_motors_drv, arg_dir, arg_val);
    }
+   else if (strcmp(argv[1], cmd_w_param[2]) == 0) { // prof
+      ret = motors_drv_move_step_profile(dev_motors_drv, arg_dir, arg_val, 
+         shell_profile_set ? &shell_profile : NULL);
+   }
+   else if (strcmp(argv[1], cmd_w_param[3]) == 0) { // dcnow
+      ret = motors_drv_move_dc_immediate(dev_motors_drv, arg_dir, arg_val);
+   }
 
    if (ret != 0)
    {
@@ -90,10 +100,269 @@ static int32_t cmd_move(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static int32_t cmd_profile(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   uint32_t arg_val[3];
+   char *end;
+
+   for (uint8_t i = 0; i < ARRAY_SIZE(arg_val); i++)
+   {
+      arg_val[i] = strtoul(argv[i + 1], &end, 10);
+      if (*end != '\0')
+      {
+         shell_lib_error(sh, "Invalid arg[%d]: %s", (int32_t)(i + 1), argv[i + 1]);
+         return -EINVAL;
+      }
+   }
+
+   shell_profile.max_vel = arg_val[0];
+   shell_profile.accel = arg_val[1];
+   shell_profile.jerk = arg_val[2];
+   shell_profile_set = true;
+
+   return 0;
+}
+
+static int32_t cmd_queue(const struct shell *sh, size_t argc, char **argv)
+{
+   const char *cmd_queue_param[MOTORS_DRV_TOTAL_CMD_QUEUE] = {
+      "dc", "step", "prof" };
+   struct motors_drv_segment seg = { 0 };
+   uint32_t arg_val[4] = { 0 };
+   int32_t ret = 0;
+   char *end;
+
+   for (uint8_t i = 2; i < argc; i++)
+   {
+      arg_val[i - 2] = strtoul(argv[i], &end, 10);
+      if (*end != '\0')
+      {
+         shell_lib_error(sh, "Invalid arg[%d]: %s", (int32_t)i, argv[i]);
+         return -EINVAL;
+      }
+   }
+
+   if (strcmp(argv[1], cmd_queue_param[0]) == 0) { // dc
+      seg.type = MOTORS_DRV_SEG_DC;
+      seg.duty_cycle_per = arg_val[1];
+   }
+   else if (strcmp(argv[1], cmd_queue_param[1]) == 0) { // step
+      seg.type = MOTORS_DRV_SEG_STEP;
+      seg.n_steps = arg_val[1];
+   }
+   else if (strcmp(argv[1], cmd_queue_param[2]) == 0) { // prof
+      seg.type = MOTORS_DRV_SEG_STEP_PROFILE;
+      seg.n_steps = arg_val[1];
+   }
+   else
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   seg.dir = arg_val[0];
+   seg.hold_ms = arg_val[2];
+   seg.flags = arg_val[3];
+
+   ret = motors_drv_queue(dev_motors_drv, &seg);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_flush(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   int32_t ret = 0;
+
+   ret = motors_drv_flush(dev_motors_drv);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_qstat(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   struct motors_drv_queue_stats stats;
+   int32_t ret = 0;
+
+   ret = motors_drv_get_queue_stats(dev_motors_drv, &stats);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   shell_lib_print(sh, "active: %d, depth: %d/%d (max %d)", (int32_t)stats.active, 
+      stats.depth, CONFIG_MOTORS_DRV_QUEUE_DEPTH, stats.depth_max);
+   shell_lib_print(sh, "completed: %d, underruns: %d", stats.completed, stats.underruns);
+
+   return 0;
+}
+
+static int32_t cmd_pos(const struct shell *sh, size_t argc, char **argv)
+{
+   int32_t ret = 0;
+   int32_t position;
+   char *end;
+
+   // Move to the given position, if any
+   if (argc > 1)
+   {
+      position = strtol(argv[1], &end, 10);
+      if (*end != '\0')
+      {
+         shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+         return -EINVAL;
+      }
+      ret = motors_drv_move_to(dev_motors_drv, position);
+      if (ret != 0)
+      {
+         shell_lib_error(sh, "ret err %d", ret);
+         return -EIO;
+      }
+   }
+
+   ret = motors_drv_get_position(dev_motors_drv, &position);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+   shell_lib_print(sh, "position: %d", position);
+
+   return 0;
+}
+
+static int32_t cmd_home(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   int32_t ret = 0;
+
+   ret = motors_drv_home(dev_motors_drv);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_pwr(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   const char *state_str[] = { "off", "waking", "on", "idle" };
+   struct motors_drv_pwr_stats stats;
+   int32_t ret = 0;
+
+   ret = motors_drv_get_pwr_stats(dev_motors_drv, &stats);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   shell_lib_print(sh, "state: %s, users: 0x%x, wake-ups: %d", state_str[stats.state], 
+      (uint32_t)stats.users, stats.wake_cnt);
+   shell_lib_print(sh, "powered: %d ms of %d ms", (int32_t)stats.on_ms, 
+      (int32_t)stats.uptime_ms);
+
+   return 0;
+}
+
+static int32_t cmd_sense(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   struct motors_drv_sense_stats stats;
+   int32_t ret = 0;
+
+   ret = motors_drv_get_sense_stats(dev_motors_drv, &stats);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   shell_lib_print(sh, "batches: %d, mean: %d mA, max: %d mA, peak: %d mA", stats.batches, 
+      stats.mean_ma, stats.max_ma, stats.peak_ma);
+   shell_lib_print(sh, "stalls: %d, over-currents: %d, abort: %d us max", stats.stalls, 
+      stats.overcurrents, stats.abort_us_max);
+
+   return 0;
+}
+
+static int32_t cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+   struct motors_drv_step_stats stats;
+   bool reset = false;
+   int32_t ret = 0;
+
+   if (argc > 1)
+   {
+      if (strcmp(argv[1], "reset") != 0)
+      {
+         shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+         return -EINVAL;
+      }
+      reset = true;
+   }
+
+   ret = motors_drv_get_step_stats(dev_motors_drv, &stats, reset);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   shell_lib_print(sh, "periods: %d, error min: %d ns, max: %d ns, mean: %d ns", 
+      stats.periods, stats.err_min_ns, stats.err_max_ns, stats.err_mean_ns);
+   for (uint8_t i = 0; i < MOTORS_DRV_STEP_HIST_LEN; i++)
+   {
+      if (stats.hist[i] == 0) {
+         continue;
+      }
+      if (i == (MOTORS_DRV_STEP_HIST_LEN - 1)) {
+         shell_lib_print(sh, "  >= %8d ns: %d", (1 << (MOTORS_DRV_STEP_HIST_SHIFT + i - 1)), 
+            stats.hist[i]);
+      }
+      else {
+         shell_lib_print(sh, "  <  %8d ns: %d", (1 << (MOTORS_DRV_STEP_HIST_SHIFT + i)), 
+            stats.hist[i]);
+      }
+   }
+
+   return 0;
+}
+
 
 SHELL_STATIC_SUBCMD_SET_CREATE(motors_drv_cmd,
-	SHELL_CMD_ARG(w, NULL, "motors_drv w [param] [value]", cmd_w, 3, 0),
-	SHELL_CMD_ARG(move, NULL, "motors_drv move [dc/step] [dir] [pwm_duty/steps]", cmd_move, 4, 0),
+	SHELL_CMD_ARG(w, NULL, "motors_drv w [pwm] [permille]", cmd_w, 3, 0),
+	SHELL_CMD_ARG(move, NULL, "motors_drv move [dc/step/prof/dcnow] [dir] [pwm_duty/steps]", cmd_move, 4, 0),
+	SHELL_CMD_ARG(profile, NULL, "motors_drv profile [max_vel] [accel] [jerk]", cmd_profile, 4, 0),
+	SHELL_CMD_ARG(queue, NULL, 
+      "motors_drv queue [dc/step/prof] [dir] [pwm_duty/steps] [hold_ms] [flags]", cmd_queue, 4, 2),
+	SHELL_CMD_ARG(flush, NULL, "motors_drv flush", cmd_flush, 1, 0),
+	SHELL_CMD_ARG(qstat, NULL, "motors_drv qstat", cmd_qstat, 1, 0),
+	SHELL_CMD_ARG(pos, NULL, "motors_drv pos [position (optional)]", cmd_pos, 1, 1),
+	SHELL_CMD_ARG(home, NULL, "motors_drv home", cmd_home, 1, 0),
+	SHELL_CMD_ARG(pwr, NULL, "motors_drv pwr", cmd_pwr, 1, 0),
+	SHELL_CMD_ARG(sense, NULL, "motors_drv sense", cmd_sense, 1, 0),
+	SHELL_CMD_ARG(stats, NULL, "motors_drv stats [reset (optional)]", cmd_stats, 1, 1),
 	SHELL_SUBCMD_SET_END // Array terminated
 );
 SHELL_CMD_REGISTER(motors_drv, &motors_drv_cmd, "motors driver cmds", NULL);
@@ -0,0 +1,139 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_profile.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Stepper motion profile (ramp table) generation for the motors driver.
+ */
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+#include <errno.h>
+
+#include <driver/motors/motors_profile.h>
+
+LOG_MODULE_REGISTER(LOG_MOTORS_PROFILE);
+
+
+static uint32_t isqrt64(uint64_t val)
+{
+   uint64_t res = 0, bit = (uint64_t)1 << 62;
+
+   while (bit > val) {
+      bit >>= 2;
+   }
+   while (bit != 0)
+   {
+      if (val >= res + bit)
+      {
+         val -= res + bit;
+         res = (res >> 1) + bit;
+      }
+      else {
+         res >>= 1;
+      }
+      bit >>= 2;
+   }
+
+   return (uint32_t)res;
+}
+
+// Trapezoidal: v(i) = sqrt(v0^2 + 2 * a * i) after i steps
+static uint32_t build_trapezoid(const struct motors_drv_profile *profile, uint32_t v_start,
+   uint32_t *ramp_us, uint32_t max_len, uint32_t *v_end)
+{
+   uint32_t i, v = v_start;
+   const uint64_t v0_sq = (uint64_t)v_start * v_start;
+
+   for (i = 0; i < max_len; i++)
+   {
+      v = isqrt64(v0_sq + (2ULL * profile->accel * i));
+      if (v >= profile->max_vel) {
+         break;
+      }
+      ramp_us[i] = USEC_PER_SEC / v;
+   }
+   *v_end = MIN(v, profile->max_vel);
+
+   return i;
+}
+
+// S-curve: integrate jerk -> acceleration -> velocity over each STEP period. Velocity
+// and acceleration are kept in milli-units to keep the integration precise.
+static uint32_t build_scurve(const struct motors_drv_profile *profile, uint32_t v_start,
+   uint32_t *ramp_us, uint32_t max_len, uint32_t *v_end)
+{
+   uint32_t i, period_us;
+   uint64_t v_m = (uint64_t)v_start * 1000, a_m = 0, da_m, dv_ramp_down_m;
+   const uint64_t v_max_m = (uint64_t)profile->max_vel * 1000;
+   const uint64_t a_max_m = (uint64_t)profile->accel * 1000;
+
+   for (i = 0; i < max_len; i++)
+   {
+      if (v_m >= v_max_m) {
+         break;
+      }
+      period_us = (uint32_t)((USEC_PER_SEC * 1000ULL) / v_m);
+      ramp_us[i] = period_us;
+
+      // Start ramping acceleration down early enough to reach max velocity with a = 0
+      da_m = ((uint64_t)profile->jerk * period_us) / 1000;
+      dv_ramp_down_m = (a_m * a_m) / (2000ULL * profile->jerk);
+      if ((v_m + dv_ramp_down_m) >= v_max_m)
+      {
+         if (a_m <= da_m)
+         {
+            v_m = v_max_m;
+            i++;
+            break;
+         }
+         a_m -= da_m;
+      }
+      else {
+         a_m = MIN(a_m + da_m, a_max_m);
+      }
+      v_m += MAX((a_m * period_us) / USEC_PER_SEC, 1);
+   }
+   *v_end = (uint32_t)(MIN(v_m, v_max_m) / 1000);
+
+   return i;
+}
+
+int32_t motors_profile_build(const struct motors_drv_profile *profile, uint32_t v_start,
+   uint32_t *ramp_us, uint32_t max_len, uint32_t *cruise_us)
+{
+   uint32_t len, v_end;
+
+   if ((profile->max_vel == 0) || (profile->accel == 0) || (v_start == 0))
+   {
+      LOG_ERR("Invalid profile, max_vel: %d, accel: %d, v_start: %d",
+         (int32_t)profile->max_vel, (int32_t)profile->accel, (int32_t)v_start);
+      return -EINVAL;
+   }
+
+   // Max velocity at or below the start velocity, no ramp needed
+   if (profile->max_vel <= v_start)
+   {
+      *cruise_us = USEC_PER_SEC / profile->max_vel;
+      return 0;
+   }
+
+   if (profile->jerk == 0) {
+      len = build_trapezoid(profile, v_start, ramp_us, max_len, &v_end);
+   }
+   else {
+      len = build_scurve(profile, v_start, ramp_us, max_len, &v_end);
+   }
+   *cruise_us = USEC_PER_SEC / MAX(v_end, v_start);
+
+   LOG_DBG("Profile ramp: %d steps, cruise %d us", (int32_t)len, (int32_t)*cruise_us);
+
+   return len;
+}
@@ -0,0 +1,408 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_pulse_nrfx.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Hardware STEP pulse engine using nRF TIMER, GPIOTE and PPI.
+ *
+ *             TIMER2 runs at 1 MHz and sends a fixed width STEP pulse every period: a
+ *             GPIOTE toggle task raises STEP on COMPARE0 and lowers it PULSE_HIGH_US
+ *             later on COMPARE2. Both edges sit at fixed times at the start of every
+ *             period so the period (COMPARE1, clears the timer) can be changed on the
+ *             fly without ever flipping the STEP polarity. This is not a square wave,
+ *             STEP stays low for the rest of the period. Every
+ *             falling edge also clocks TIMER3 in counter mode and once TIMER3 reaches
+ *             n_pulses it stops TIMER2 through PPI and raises the done interrupt.
+ *
+ *             A constant rate move raises a single interrupt. Ramped moves also take
+ *             one short interrupt per pulse while accelerating or decelerating to load
+ *             the next period from the ramp table.
+ *
+ *             Each motors instance owns one TIMER pair. TIMER1 + TIMER4 provide a
+ *             second pair when CONFIG_MOTORS_DRV_PULSE_NRFX_TIMER_1_4 is enabled.
+ */
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+
+#include <nrfx_timer.h>
+#include <nrfx_gpiote.h>
+#include <nrfx_ppi.h>
+
+#include <errno.h>
+
+#include <driver/motors/motors_pulse.h>
+
+LOG_MODULE_REGISTER(LOG_MOTORS_PULSE);
+
+
+// STEP high time, well above the minimum of common STEP/DIR drivers
+#define PULSE_RISE_US         1
+#define PULSE_HIGH_US         2
+#define PULSE_FALL_US         (PULSE_RISE_US + PULSE_HIGH_US)
+#define PULSE_MIN_PERIOD_US   (PULSE_FALL_US + 2)
+
+// TIMER2 channels
+#define CC_RISE               NRF_TIMER_CC_CHANNEL0
+#define CC_PERIOD             NRF_TIMER_CC_CHANNEL1
+#define CC_FALL               NRF_TIMER_CC_CHANNEL2
+#define CC_NOW                NRF_TIMER_CC_CHANNEL3
+// TIMER3 channels
+#define CC_DONE               NRF_TIMER_CC_CHANNEL0
+#define CC_COUNT              NRF_TIMER_CC_CHANNEL1
+#define CC_DECEL              NRF_TIMER_CC_CHANNEL2
+
+
+#define PULSE_HW_IRQ_CONNECT(pulse_idx, count_idx)                            \
+   IRQ_CONNECT(NRFX_CONCAT_3(TIMER, pulse_idx, _IRQn),                        \
+      CONFIG_MOTORS_DRV_PULSE_IRQ_PRIORITY,                                   \
+      NRFX_CONCAT_3(nrfx_timer_, pulse_idx, _irq_handler), NULL, 0);         \
+   IRQ_CONNECT(NRFX_CONCAT_3(TIMER, count_idx, _IRQn),                        \
+      CONFIG_MOTORS_DRV_PULSE_IRQ_PRIORITY,                                   \
+      NRFX_CONCAT_3(nrfx_timer_, count_idx, _irq_handler), NULL, 0)
+
+
+struct pulse_hw {
+   const nrfx_timer_t pulse_timer;
+   const nrfx_timer_t count_timer;
+   nrf_ppi_channel_t ppi_rise;
+   nrf_ppi_channel_t ppi_fall;
+   nrf_ppi_channel_t ppi_stop;
+   struct motors_pulse *pulse;      // Owner, NULL while free
+};
+
+
+static struct pulse_hw pulse_hw[] = {
+   {
+      .pulse_timer = NRFX_TIMER_INSTANCE(2),
+      .count_timer = NRFX_TIMER_INSTANCE(3),
+   },
+#if CONFIG_MOTORS_DRV_PULSE_NRFX_TIMER_1_4
+   {
+      .pulse_timer = NRFX_TIMER_INSTANCE(1),
+      .count_timer = NRFX_TIMER_INSTANCE(4),
+   },
+#endif
+};
+
+
+#if CONFIG_MOTORS_DRV_STATS
+static void stats_train_end(struct motors_pulse *pulse, uint32_t n_pulses)
+{
+   struct motors_drv_step_stats *stats = &pulse->stats;
+   uint32_t exact = n_pulses - MIN(pulse->stats_train_cnt, n_pulses);
+
+   // Periods not reloaded by the ISR run straight off the TIMER and are exact
+   if (exact == 0) {
+      return;
+   }
+   if (stats->periods == 0)
+   {
+      stats->err_min_ns = 0;
+      stats->err_max_ns = 0;
+   }
+   stats->err_min_ns = MIN(stats->err_min_ns, 0);
+   stats->err_max_ns = MAX(stats->err_max_ns, 0);
+   stats->hist[0] += exact;
+   stats->periods += exact;
+   pulse->stats_train_cnt += exact;
+}
+#endif
+
+static void set_period(struct motors_pulse *pulse, uint32_t period_us)
+{
+   struct pulse_hw *hw = pulse->hw;
+   uint32_t now;
+
+   nrfx_timer_compare(&hw->pulse_timer, CC_PERIOD, period_us, false);
+
+   // Period end already passed (e.g., ISR was held off), end it as soon as possible
+   // instead of letting the timer run until it wraps
+   now = nrfx_timer_capture(&hw->pulse_timer, CC_NOW);
+   if (now >= period_us)
+   {
+      nrfx_timer_compare(&hw->pulse_timer, CC_PERIOD, now + 2, false);
+      pulse->late_cnt++;
+   }
+#if CONFIG_MOTORS_DRV_STATS
+   // STEP edges come from the TIMER, a period is only off when its reload was late
+   motors_pulse_stats_add(pulse, 
+      (now >= period_us) ? (int32_t)((now + 2 - period_us) * NSEC_PER_USEC) : 0);
+#endif
+}
+
+static void pulse_timer_handler(nrf_timer_event_t event_type, void *p_context)
+{
+   struct pulse_hw *hw = p_context;
+   struct motors_pulse *pulse = hw->pulse;
+
+   if ((event_type != NRF_TIMER_EVENT_COMPARE2) || (pulse == NULL)) {
+      return;
+   }
+
+   // Falling edge of pulse idx, load the period of the current cycle
+   set_period(pulse, motors_pulse_period_us(pulse, pulse->idx));
+
+   // Cruising, no need to interrupt until deceleration starts
+   if ((pulse->idx == pulse->ramp_len) &&
+      (pulse->idx < (pulse->n_pulses - pulse->ramp_len))) {
+      nrfx_timer_compare_int_disable(&hw->pulse_timer, CC_FALL);
+   }
+   pulse->idx++;
+}
+
+static void count_timer_handler(nrf_timer_event_t event_type, void *p_context)
+{
+   struct pulse_hw *hw = p_context;
+   struct motors_pulse *pulse = hw->pulse;
+
+   if (pulse == NULL) {
+      return;
+   }
+
+   switch (event_type)
+   {
+   case NRF_TIMER_EVENT_COMPARE2:
+      // Last cruise pulse is out, go back to per-pulse period updates for deceleration
+      pulse->idx = pulse->n_pulses - pulse->ramp_len;
+      nrfx_timer_compare_int_enable(&hw->pulse_timer, CC_FALL);
+      break;
+   case NRF_TIMER_EVENT_COMPARE0:
+      // TIMER2 has already been stopped by PPI, STEP is low
+      nrfx_timer_disable(&hw->pulse_timer);
+      nrfx_timer_disable(&hw->count_timer);
+      nrfx_timer_compare_int_disable(&hw->pulse_timer, CC_FALL);
+      pulse->idx = pulse->n_pulses;
+      pulse->busy = false;
+#if CONFIG_MOTORS_DRV_STATS
+      stats_train_end(pulse, pulse->n_pulses);
+#endif
+      if (pulse->done_cb != NULL) {
+         pulse->done_cb(pulse->dev, pulse->n_pulses);
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+int32_t motors_pulse_start_ramp(struct motors_pulse *pulse, uint32_t n_pulses,
+   const uint32_t *ramp_us, uint32_t ramp_len, uint32_t cruise_us)
+{
+   struct pulse_hw *hw = pulse->hw;
+
+   if (cruise_us < PULSE_MIN_PERIOD_US)
+   {
+      LOG_ERR("Invalid pulse period: %d us", (int32_t)cruise_us);
+      return -EINVAL;
+   }
+
+   if (pulse->busy) {
+      motors_pulse_stop(pulse);
+   }
+
+   pulse->n_pulses = n_pulses;
+   pulse->ramp_us = ramp_us;
+   pulse->ramp_len = (ramp_us != NULL) ? MIN(ramp_len, n_pulses / 2) : 0;
+   pulse->cruise_us = cruise_us;
+   pulse->idx = 0;
+   pulse->busy = true;
+#if CONFIG_MOTORS_DRV_STATS
+   pulse->stats_train_cnt = 0;
+#endif
+
+   nrfx_timer_clear(&hw->pulse_timer);
+   nrfx_timer_clear(&hw->count_timer);
+   if (n_pulses == 0)
+   {
+      // Nothing to send, one count without a STEP pulse raises the done interrupt so that
+      // done_cb still runs in ISR context
+      nrfx_timer_compare(&hw->count_timer, CC_DONE, 1, true);
+      nrfx_timer_compare_int_disable(&hw->count_timer, CC_DECEL);
+      nrfx_timer_enable(&hw->count_timer);
+      nrfx_timer_increment(&hw->count_timer);
+      return 0;
+   }
+   nrfx_timer_compare(&hw->count_timer, CC_DONE, n_pulses, true);
+   nrfx_timer_compare(&hw->pulse_timer, CC_RISE, PULSE_RISE_US, false);
+   nrfx_timer_compare(&hw->pulse_timer, CC_FALL, PULSE_FALL_US, (pulse->ramp_len > 0));
+   nrfx_timer_extended_compare(&hw->pulse_timer, CC_PERIOD,
+      MAX(motors_pulse_period_us(pulse, 0), PULSE_MIN_PERIOD_US),
+      NRF_TIMER_SHORT_COMPARE1_CLEAR_MASK, false);
+   if ((pulse->ramp_len > 0) && (n_pulses > (2 * pulse->ramp_len))) {
+      nrfx_timer_compare(&hw->count_timer, CC_DECEL, n_pulses - pulse->ramp_len, true);
+   }
+   else {
+      nrfx_timer_compare_int_disable(&hw->count_timer, CC_DECEL);
+   }
+
+   nrfx_timer_enable(&hw->count_timer);
+   nrfx_timer_enable(&hw->pulse_timer);
+
+   return 0;
+}
+
+int32_t motors_pulse_start(struct motors_pulse *pulse, uint32_t n_pulses, uint32_t period_us)
+{
+   return motors_pulse_start_ramp(pulse, n_pulses, NULL, 0, period_us);
+}
+
+uint32_t motors_pulse_stop(struct motors_pulse *pulse)
+{
+   struct pulse_hw *hw = pulse->hw;
+   uint32_t key, cnt;
+
+   key = irq_lock();
+   if (!pulse->busy)
+   {
+      irq_unlock(key);
+      return motors_pulse_get_count(pulse);
+   }
+
+   nrfx_timer_pause(&hw->pulse_timer);
+   // The count of an empty train is not a STEP pulse
+   cnt = MIN(nrfx_timer_capture(&hw->count_timer, CC_COUNT), pulse->n_pulses);
+   nrfx_timer_disable(&hw->pulse_timer);
+   nrfx_timer_disable(&hw->count_timer);
+   nrfx_timer_compare_int_disable(&hw->pulse_timer, CC_FALL);
+   nrfx_gpiote_clr_task_trigger(pulse->cfg->step_psel);
+   pulse->busy = false;
+   pulse->n_pulses = cnt;
+   pulse->idx = cnt;
+#if CONFIG_MOTORS_DRV_STATS
+   stats_train_end(pulse, cnt);
+#endif
+   irq_unlock(key);
+
+   return cnt;
+}
+
+uint32_t motors_pulse_get_count(struct motors_pulse *pulse)
+{
+   struct pulse_hw *hw = pulse->hw;
+
+   if (!pulse->busy) {
+      return pulse->n_pulses;
+   }
+
+   return MIN(nrfx_timer_capture(&hw->count_timer, CC_COUNT), pulse->n_pulses);
+}
+
+int32_t motors_pulse_init(struct motors_pulse *pulse, const struct device *dev,
+   const struct motors_pulse_cfg *cfg, motors_pulse_done_cb_t done_cb)
+{
+   nrfx_err_t err;
+   uint8_t gpiote_ch;
+   uint8_t hw_idx;
+   struct pulse_hw *hw = NULL;
+   nrfx_timer_config_t timer_cfg = NRFX_TIMER_DEFAULT_CONFIG;
+
+   // Claim a free TIMER pair
+   for (hw_idx = 0; hw_idx < ARRAY_SIZE(pulse_hw); hw_idx++)
+   {
+      if (pulse_hw[hw_idx].pulse == NULL)
+      {
+         hw = &pulse_hw[hw_idx];
+         break;
+      }
+   }
+   if (hw == NULL)
+   {
+      LOG_ERR("No free hardware pulse engine for %s", dev->name);
+      return -EBUSY;
+   }
+
+   pulse->dev = dev;
+   pulse->cfg = cfg;
+   pulse->done_cb = done_cb;
+   pulse->busy = false;
+   pulse->n_pulses = 0;
+   pulse->ramp_us = NULL;
+   pulse->ramp_len = 0;
+   pulse->idx = 0;
+   pulse->late_cnt = 0;
+   pulse->hw = hw;
+
+   // STEP pulse timer (1 MHz tick, period set per pulse)
+   timer_cfg.frequency = NRF_TIMER_FREQ_1MHz;
+   timer_cfg.bit_width = NRF_TIMER_BIT_WIDTH_32;
+   timer_cfg.p_context = hw;
+   err = nrfx_timer_init(&hw->pulse_timer, &timer_cfg, pulse_timer_handler);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_timer_init() failed for pulse timer, err 0x%08X", err);
+      return -EBUSY;
+   }
+
+   // STEP pulse counter
+   timer_cfg.mode = NRF_TIMER_MODE_COUNTER;
+   err = nrfx_timer_init(&hw->count_timer, &timer_cfg, count_timer_handler);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_timer_init() failed for count timer, err 0x%08X", err);
+      return -EBUSY;
+   }
+
+   if (hw_idx == 0) {
+      PULSE_HW_IRQ_CONNECT(2, 3);
+   }
+#if CONFIG_MOTORS_DRV_PULSE_NRFX_TIMER_1_4
+   else {
+      PULSE_HW_IRQ_CONNECT(1, 4);
+   }
+#endif
+
+   // Hand the STEP pin over to a GPIOTE task, idle low
+   err = nrfx_gpiote_channel_alloc(&gpiote_ch);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_gpiote_channel_alloc() failed, err 0x%08X", err);
+      return -ENOMEM;
+   }
+   const nrfx_gpiote_output_config_t out_cfg = NRFX_GPIOTE_DEFAULT_OUTPUT_CONFIG;
+   const nrfx_gpiote_task_config_t task_cfg = {
+      .task_ch  = gpiote_ch,
+      .polarity = NRF_GPIOTE_POLARITY_TOGGLE,
+      .init_val = NRF_GPIOTE_INITIAL_VALUE_LOW,
+   };
+   err = nrfx_gpiote_output_configure(cfg->step_psel, &out_cfg, &task_cfg);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_gpiote_output_configure() failed, err 0x%08X", err);
+      return -EIO;
+   }
+   nrfx_gpiote_out_task_enable(cfg->step_psel);
+
+   // Wire pulse timer edges to the STEP toggle task and count timer count / stop tasks
+   if ((nrfx_ppi_channel_alloc(&hw->ppi_rise) != NRFX_SUCCESS) ||
+      (nrfx_ppi_channel_alloc(&hw->ppi_fall) != NRFX_SUCCESS) ||
+      (nrfx_ppi_channel_alloc(&hw->ppi_stop) != NRFX_SUCCESS))
+   {
+      LOG_ERR("nrfx_ppi_channel_alloc() failed");
+      return -ENOMEM;
+   }
+   nrfx_ppi_channel_assign(hw->ppi_rise,
+      nrfx_timer_compare_event_address_get(&hw->pulse_timer, CC_RISE),
+      nrfx_gpiote_out_task_addr_get(cfg->step_psel));
+   nrfx_ppi_channel_assign(hw->ppi_fall,
+      nrfx_timer_compare_event_address_get(&hw->pulse_timer, CC_FALL),
+      nrfx_gpiote_out_task_addr_get(cfg->step_psel));
+   nrfx_ppi_channel_fork_assign(hw->ppi_fall,
+      nrfx_timer_task_address_get(&hw->count_timer, NRF_TIMER_TASK_COUNT));
+   nrfx_ppi_channel_assign(hw->ppi_stop,
+      nrfx_timer_compare_event_address_get(&hw->count_timer, CC_DONE),
+      nrfx_timer_task_address_get(&hw->pulse_timer, NRF_TIMER_TASK_STOP));
+   nrfx_ppi_channel_enable(hw->ppi_rise);
+   nrfx_ppi_channel_enable(hw->ppi_fall);
+   nrfx_ppi_channel_enable(hw->ppi_stop);
+   hw->pulse = pulse;
+
+   return 0;
+}
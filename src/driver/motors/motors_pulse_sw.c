@@ -0,0 +1,166 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_pulse_sw.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Software STEP pulse engine using a k_timer. Takes two timer interrupts
+ *             per pulse (50% duty cycle), so it is meant for targets without the nRF
+ *             pulse hardware (e.g., native_posix) where exact pulse counts matter more
+ *             than jitter.
+ */
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/gpio.h>
+
+#include <errno.h>
+
+#include <driver/motors/motors_pulse.h>
+
+LOG_MODULE_REGISTER(LOG_MOTORS_PULSE);
+
+
+#define PULSE_MIN_PERIOD_US   2
+
+
+#if CONFIG_MOTORS_DRV_STATS
+static void stats_edge(struct motors_pulse *pulse)
+{
+   timing_t now = timing_counter_get();
+   int64_t period_ns, expect_ns;
+
+   // Rising edge to rising edge, the first pulse of a train has nothing to compare with
+   if (pulse->idx > 0)
+   {
+      period_ns = timing_cycles_to_ns(timing_cycles_get(&pulse->stats_last_edge, &now));
+      expect_ns = (int64_t)(motors_pulse_period_us(pulse, pulse->idx - 1) / 2) * 2 * 
+         NSEC_PER_USEC;
+      motors_pulse_stats_add(pulse, (int32_t)CLAMP(period_ns - expect_ns, INT32_MIN, INT32_MAX));
+   }
+   pulse->stats_last_edge = now;
+}
+#endif
+
+static void pulse_timer_cb(struct k_timer *timer)
+{
+   struct motors_pulse *pulse = CONTAINER_OF(timer, struct motors_pulse, timer);
+   uint32_t half_us = motors_pulse_period_us(pulse, pulse->idx) / 2;
+
+   // Empty train, only the done callback is left
+   if (pulse->n_pulses == 0)
+   {
+      pulse->busy = false;
+      if (pulse->done_cb != NULL) {
+         pulse->done_cb(pulse->dev, 0);
+      }
+      return;
+   }
+
+   if (!pulse->level)
+   {
+      gpio_pin_set_dt(&pulse->cfg->step_gpio, 1);
+#if CONFIG_MOTORS_DRV_STATS
+      stats_edge(pulse);
+#endif
+   }
+   else
+   {
+      gpio_pin_set_dt(&pulse->cfg->step_gpio, 0);
+      pulse->idx++;
+      if (pulse->idx >= pulse->n_pulses)
+      {
+         pulse->level = false;
+         pulse->busy = false;
+         if (pulse->done_cb != NULL) {
+            pulse->done_cb(pulse->dev, pulse->idx);
+         }
+         return;
+      }
+      half_us = motors_pulse_period_us(pulse, pulse->idx) / 2;
+   }
+   pulse->level = !pulse->level;
+   k_timer_start(&pulse->timer, K_USEC(half_us), K_NO_WAIT);
+}
+
+int32_t motors_pulse_start_ramp(struct motors_pulse *pulse, uint32_t n_pulses,
+   const uint32_t *ramp_us, uint32_t ramp_len, uint32_t cruise_us)
+{
+   if (cruise_us < PULSE_MIN_PERIOD_US)
+   {
+      LOG_ERR("Invalid pulse period: %d us", (int32_t)cruise_us);
+      return -EINVAL;
+   }
+
+   if (pulse->busy) {
+      motors_pulse_stop(pulse);
+   }
+
+   pulse->n_pulses = n_pulses;
+   pulse->ramp_us = ramp_us;
+   pulse->ramp_len = (ramp_us != NULL) ? MIN(ramp_len, n_pulses / 2) : 0;
+   pulse->cruise_us = cruise_us;
+   pulse->idx = 0;
+   pulse->level = false;
+   pulse->busy = true;
+#if CONFIG_MOTORS_DRV_STATS
+   pulse->stats_train_cnt = 0;
+#endif
+   // An empty train completes from the timer too, done_cb always runs in ISR context
+   k_timer_start(&pulse->timer, (n_pulses == 0) ? K_NO_WAIT : 
+      K_USEC(motors_pulse_period_us(pulse, 0) / 2), K_NO_WAIT);
+
+   return 0;
+}
+
+int32_t motors_pulse_start(struct motors_pulse *pulse, uint32_t n_pulses, uint32_t period_us)
+{
+   return motors_pulse_start_ramp(pulse, n_pulses, NULL, 0, period_us);
+}
+
+uint32_t motors_pulse_stop(struct motors_pulse *pulse)
+{
+   k_timer_stop(&pulse->timer);
+   gpio_pin_set_dt(&pulse->cfg->step_gpio, 0);
+   pulse->level = false;
+   pulse->busy = false;
+   pulse->n_pulses = pulse->idx;
+
+   return pulse->idx;
+}
+
+uint32_t motors_pulse_get_count(struct motors_pulse *pulse)
+{
+   return pulse->idx;
+}
+
+int32_t motors_pulse_init(struct motors_pulse *pulse, const struct device *dev,
+   const struct motors_pulse_cfg *cfg, motors_pulse_done_cb_t done_cb)
+{
+   pulse->dev = dev;
+   pulse->cfg = cfg;
+   pulse->done_cb = done_cb;
+   pulse->busy = false;
+   pulse->level = false;
+   pulse->n_pulses = 0;
+   pulse->ramp_us = NULL;
+   pulse->ramp_len = 0;
+   pulse->idx = 0;
+   pulse->late_cnt = 0;
+
+   k_timer_init(&pulse->timer, pulse_timer_cb, NULL);
+
+#if CONFIG_MOTORS_DRV_STATS
+   // STEP edges are timestamped with the timing API (cycle counter where available)
+   timing_init();
+   timing_start();
+#endif
+
+   return 0;
+}
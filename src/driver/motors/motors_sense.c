@@ -0,0 +1,234 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       motors_sense.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Motors supply current sensing using the nRF SAADC.
+ *
+ *             The SAADC internal timer triggers a conversion at a fixed rate and EasyDMA
+ *             fills two buffers of CONFIG_MOTORS_DRV_SENSE_BATCH samples in turn. With
+ *             START shorted to END the next buffer is already armed when one fills up,
+ *             so sampling never stops and the CPU only wakes once per batch to reduce
+ *             the full buffer to its mean and max current.
+ *
+ *             A single sense input measures the shared motors supply (DC and stepper),
+ *             so the SAADC serves one motors instance only.
+ */
+
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+
+#include <nrfx_saadc.h>
+
+#include <errno.h>
+
+#include <driver/motors/motors_sense.h>
+
+LOG_MODULE_REGISTER(LOG_MOTORS_SENSE);
+
+
+// 12 bit, gain 1/6 and internal 0.6 V reference: 3.6 V full scale
+#define SENSE_FULL_SCALE_MV      3600
+#define SENSE_RESOLUTION_BITS    12
+
+// The internal timer runs at 16 MHz, CC must be within [80, 2047]
+#define SENSE_TIMER_HZ           16000000
+#define SENSE_TIMER_CC           (SENSE_TIMER_HZ / CONFIG_MOTORS_DRV_SENSE_RATE_HZ)
+BUILD_ASSERT((SENSE_TIMER_CC >= 80) && (SENSE_TIMER_CC <= 2047),
+   "CONFIG_MOTORS_DRV_SENSE_RATE_HZ out of the SAADC internal timer range");
+
+enum SENSE_STATE {
+   SENSE_IDLE = 0,
+   SENSE_RUNNING,
+   SENSE_STOPPING,                  // Aborted, waiting for the SAADC to finish
+};
+
+
+static struct motors_sense *sense_owner;
+static volatile uint8_t sense_state;
+static volatile bool sense_restart;
+
+
+static uint32_t raw_to_ma(const struct motors_sense *sense, int32_t raw)
+{
+   uint32_t mv;
+
+   // Single ended inputs read slightly below zero at no current
+   if (raw <= 0) {
+      return 0;
+   }
+   mv = ((uint32_t)raw * SENSE_FULL_SCALE_MV) >> SENSE_RESOLUTION_BITS;
+
+   return (mv * 1000) / sense->cfg->mv_per_a;
+}
+
+static int32_t sense_arm(struct motors_sense *sense)
+{
+   nrfx_err_t err;
+
+   sense->buf_next = 1;
+   err = nrfx_saadc_buffer_set(sense->buf[0], CONFIG_MOTORS_DRV_SENSE_BATCH);
+   if (err == NRFX_SUCCESS) {
+      err = nrfx_saadc_mode_trigger();
+   }
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("Unable to start sampling, err 0x%08X", err);
+      return -EIO;
+   }
+   sense_state = SENSE_RUNNING;
+
+   return 0;
+}
+
+static void sense_batch(struct motors_sense *sense, const int16_t *buf, uint16_t size)
+{
+   int32_t sum = 0;
+   int16_t max = 0;
+
+   // Partial buffers are left over from an abort
+   if ((sense_state != SENSE_RUNNING) || (size != CONFIG_MOTORS_DRV_SENSE_BATCH)) {
+      return;
+   }
+
+   for (uint16_t i = 0; i < size; i++)
+   {
+      sum += buf[i];
+      max = MAX(max, buf[i]);
+   }
+   sense->batch_cnt++;
+
+   if (sense->batch_cb != NULL) {
+      sense->batch_cb(sense->dev, raw_to_ma(sense, sum / size), raw_to_ma(sense, max));
+   }
+}
+
+static void saadc_handler(nrfx_saadc_evt_t const *p_event)
+{
+   struct motors_sense *sense = sense_owner;
+
+   switch (p_event->type)
+   {
+   case NRFX_SAADC_EVT_BUF_REQ:
+      // Arm the other buffer while this one is being filled
+      (void)nrfx_saadc_buffer_set(sense->buf[sense->buf_next], CONFIG_MOTORS_DRV_SENSE_BATCH);
+      sense->buf_next ^= 1;
+      break;
+   case NRFX_SAADC_EVT_DONE:
+      sense_batch(sense, p_event->data.done.p_buffer, p_event->data.done.size);
+      break;
+   case NRFX_SAADC_EVT_FINISHED:
+      sense_state = SENSE_IDLE;
+      if (sense_restart)
+      {
+         sense_restart = false;
+         (void)sense_arm(sense);
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+int32_t motors_sense_start(struct motors_sense *sense)
+{
+   int32_t ret = 0;
+   unsigned int key = irq_lock();
+
+   switch (sense_state)
+   {
+   case SENSE_IDLE:
+      ret = sense_arm(sense);
+      break;
+   case SENSE_STOPPING:
+      // Restarted before the abort completed, pick it up once the SAADC is idle
+      sense_restart = true;
+      break;
+   default:
+      break;
+   }
+   irq_unlock(key);
+
+   return ret;
+}
+
+void motors_sense_stop(struct motors_sense *sense)
+{
+   ARG_UNUSED(sense);
+   unsigned int key = irq_lock();
+
+   sense_restart = false;
+   if (sense_state == SENSE_RUNNING)
+   {
+      sense_state = SENSE_STOPPING;
+      nrfx_saadc_abort();
+   }
+   irq_unlock(key);
+}
+
+int32_t motors_sense_init(struct motors_sense *sense, const struct device *dev,
+   const struct motors_sense_cfg *cfg, motors_sense_batch_cb_t batch_cb)
+{
+   nrfx_err_t err;
+   nrfx_saadc_channel_t channel = NRFX_SAADC_DEFAULT_CHANNEL_SE(
+      NRF_SAADC_INPUT_AIN0 + cfg->ain, 0);
+   nrfx_saadc_adv_config_t adv_cfg = NRFX_SAADC_DEFAULT_ADV_CONFIG;
+
+   if (sense_owner != NULL)
+   {
+      LOG_ERR("SAADC already used by %s", sense_owner->dev->name);
+      return -EBUSY;
+   }
+   if (cfg->mv_per_a == 0)
+   {
+      LOG_ERR("Invalid sense transresistance: 0");
+      return -EINVAL;
+   }
+
+   sense->dev = dev;
+   sense->cfg = cfg;
+   sense->batch_cb = batch_cb;
+   sense->buf_next = 0;
+   sense->batch_cnt = 0;
+
+   err = nrfx_saadc_init(CONFIG_MOTORS_DRV_SENSE_IRQ_PRIORITY);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_saadc_init() failed, err 0x%08X", err);
+      return -EBUSY;
+   }
+   IRQ_CONNECT(SAADC_IRQn, CONFIG_MOTORS_DRV_SENSE_IRQ_PRIORITY, nrfx_saadc_irq_handler,
+      NULL, 0);
+
+   // Short acquisition time is fine for the low impedance sense amplifier output
+   channel.channel_config.acq_time = NRF_SAADC_ACQTIME_3US;
+   err = nrfx_saadc_channels_config(&channel, 1);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_saadc_channels_config() failed, err 0x%08X", err);
+      return -EIO;
+   }
+
+   // Internal timer paced sampling, START is retriggered on END for back-to-back buffers
+   adv_cfg.internal_timer_cc = SENSE_TIMER_CC;
+   adv_cfg.start_on_end = true;
+   err = nrfx_saadc_advanced_mode_set(BIT(0), NRF_SAADC_RESOLUTION_12BIT, &adv_cfg,
+      saadc_handler);
+   if (err != NRFX_SUCCESS)
+   {
+      LOG_ERR("nrfx_saadc_advanced_mode_set() failed, err 0x%08X", err);
+      return -EIO;
+   }
+
+   sense_state = SENSE_IDLE;
+   sense_owner = sense;
+
+   return 0;
+}
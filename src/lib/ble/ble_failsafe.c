@@ -0,0 +1,111 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       ble_failsafe.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      BLE link-loss failsafe.
+ *
+ *             Both trip sources end up in the expiry function of a single k_timer which
+ *             runs from the system timer ISR: the keepalive timer simply expires, a
+ *             disconnect restarts it with no delay. The stop latency is measured from the
+ *             moment the failsafe should have tripped (keepalive deadline or disconnect
+ *             event) to the return of the handler.
+ *
+ *             The disconnect event itself only comes after the link supervision timeout
+ *             when the central goes out of range, use the keepalive for a tighter bound.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+#include <lib/ble/ble_failsafe.h>
+
+LOG_MODULE_REGISTER(LOG_BLE_FAILSAFE);
+
+
+static void ble_failsafe_expiry(struct k_timer *timer);
+
+static K_TIMER_DEFINE(failsafe_timer, ble_failsafe_expiry, NULL);
+static struct k_spinlock failsafe_lock;
+static ble_failsafe_handler_t failsafe_handler;
+static ble_failsafe_reason_t failsafe_reason;
+static int64_t failsafe_deadline;            // Uptime in ticks the failsafe should trip at
+static struct ble_failsafe_stats failsafe_stats = {
+   .keepalive_ms = CONFIG_BLE_FAILSAFE_KEEPALIVE_MS,
+};
+
+
+static void ble_failsafe_expiry(struct k_timer *timer)
+{
+   ARG_UNUSED(timer);
+   uint32_t start = k_cycle_get_32();
+   ble_failsafe_handler_t handler;
+   ble_failsafe_reason_t reason;
+   int64_t late;
+   uint32_t latency_us;
+
+   k_spinlock_key_t key = k_spin_lock(&failsafe_lock);
+   handler = failsafe_handler;
+   reason = failsafe_reason;
+   late = MAX(k_uptime_ticks() - failsafe_deadline, 0);
+   k_spin_unlock(&failsafe_lock, key);
+
+   if (handler != NULL) {
+      handler(reason);
+   }
+   latency_us = k_ticks_to_us_ceil32((uint32_t)late) +
+      k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+   key = k_spin_lock(&failsafe_lock);
+   failsafe_stats.trips[reason]++;
+   failsafe_stats.latency_us_last = latency_us;
+   failsafe_stats.latency_us_max = MAX(failsafe_stats.latency_us_max, latency_us);
+   k_spin_unlock(&failsafe_lock, key);
+
+   LOG_WRN("Failsafe tripped, reason %d, latency %d us", (int32_t)reason, latency_us);
+}
+
+void ble_failsafe_set_handler(ble_failsafe_handler_t handler)
+{
+   k_spinlock_key_t key = k_spin_lock(&failsafe_lock);
+   failsafe_handler = handler;
+   k_spin_unlock(&failsafe_lock, key);
+}
+
+void ble_failsafe_feed(void)
+{
+   if (CONFIG_BLE_FAILSAFE_KEEPALIVE_MS == 0) {
+      return;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&failsafe_lock);
+   failsafe_reason = BLE_FAILSAFE_KEEPALIVE;
+   failsafe_deadline = k_uptime_ticks() + k_ms_to_ticks_ceil64(CONFIG_BLE_FAILSAFE_KEEPALIVE_MS);
+   k_timer_start(&failsafe_timer, K_MSEC(CONFIG_BLE_FAILSAFE_KEEPALIVE_MS), K_NO_WAIT);
+   k_spin_unlock(&failsafe_lock, key);
+}
+
+void ble_failsafe_trip(ble_failsafe_reason_t reason)
+{
+   if (reason >= BLE_FAILSAFE_REASON_CNT) {
+      return;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&failsafe_lock);
+   failsafe_reason = reason;
+   failsafe_deadline = k_uptime_ticks();
+   k_timer_start(&failsafe_timer, K_NO_WAIT, K_NO_WAIT);
+   k_spin_unlock(&failsafe_lock, key);
+}
+
+void ble_failsafe_get_stats(struct ble_failsafe_stats *stats)
+{
+   k_spinlock_key_t key = k_spin_lock(&failsafe_lock);
+   *stats = failsafe_stats;
+   k_spin_unlock(&failsafe_lock, key);
+}
@@ -24,6 +24,12 @@
 
 #include <lib/ble/ble_lib.h>
 #include <lib/ble/ble_uart.h>
+#if CONFIG_BLE_FAILSAFE
+#include <lib/ble/ble_failsafe.h>
+#endif
+#if CONFIG_BUS_LIB
+#include <lib/bus/bus_lib.h>
+#endif
 
 LOG_MODULE_REGISTER(LOG_BLE_LIB);
 
@@ -62,12 +68,20 @@ static void ble_lib_connected(struct bt_conn *conn, uint8_t ret)
    current_conn = bt_conn_ref(conn);
 
    connection_status = true;
+#if CONFIG_BUS_LIB
+   (void)bus_lib_pub(&bus_link_chan, &(struct bus_link_state){ .connected = true });
+#endif
 }
 
 static void ble_lib_disconnected(struct bt_conn *conn, uint8_t reason)
 {
    char addr[BT_ADDR_LE_STR_LEN];
 
+#if CONFIG_BLE_FAILSAFE
+   // Stop the motors first, no more commands can come in
+   ble_failsafe_trip(BLE_FAILSAFE_DISCONNECT);
+#endif
+
    bt_addr_le_to_str(bt_conn_get_dst(conn), addr, sizeof(addr));
 
    LOG_INF("Disconnected: %s, reason %d", addr, (int32_t)reason);
@@ -85,6 +99,9 @@ static void ble_lib_disconnected(struct bt_conn *conn, uint8_t reason)
    }
 
    connection_status = false;
+#if CONFIG_BUS_LIB
+   (void)bus_lib_pub(&bus_link_chan, &(struct bus_link_state){ .connected = false });
+#endif
 }
 
 #ifdef CONFIG_BT_NUS_SECURITY_ENABLED
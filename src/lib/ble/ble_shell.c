@@ -16,6 +16,9 @@
 
 #include <lib/misc/shell_lib.h>
 #include <lib/ble/ble_lib.h>
+#if CONFIG_BLE_FAILSAFE
+#include <lib/ble/ble_failsafe.h>
+#endif
 
 
 #define BLE_LIB_TOTAL_CMD_ADV   2
@@ -44,9 +47,30 @@ static int32_t cmd_adv(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+#if CONFIG_BLE_FAILSAFE
+static int32_t cmd_failsafe(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   struct ble_failsafe_stats stats;
+
+   ble_failsafe_get_stats(&stats);
+   shell_lib_print(sh, "keepalive: %d ms, trips: %d disconnect, %d keepalive", 
+      stats.keepalive_ms, stats.trips[BLE_FAILSAFE_DISCONNECT], 
+      stats.trips[BLE_FAILSAFE_KEEPALIVE]);
+   shell_lib_print(sh, "stop latency: %d us last, %d us max", stats.latency_us_last, 
+      stats.latency_us_max);
+
+   return 0;
+}
+#endif
+
 
 SHELL_STATIC_SUBCMD_SET_CREATE(ble_lib_cmd,
 	SHELL_CMD_ARG(adv, NULL, "ble adv [start/stop]", cmd_adv, 2, 0),
+#if CONFIG_BLE_FAILSAFE
+	SHELL_CMD_ARG(failsafe, NULL, "ble failsafe", cmd_failsafe, 1, 0),
+#endif
 	SHELL_SUBCMD_SET_END // Array terminated
 );
 SHELL_CMD_REGISTER(ble, &ble_lib_cmd, "ble library cmds", NULL);
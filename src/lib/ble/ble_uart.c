@@ -21,6 +21,9 @@
 #include <stdio.h>
 
 #include <lib/ble/ble_uart.h>
+#if CONFIG_BLE_FAILSAFE
+#include <lib/ble/ble_failsafe.h>
+#endif
 #include <lib/uart/uart_lib.h>
 
 LOG_MODULE_REGISTER(LOG_BLE_UART);
@@ -36,6 +39,11 @@ static void ble_uart_receive_cb(struct bt_conn *conn, const uint8_t *const data,
    char addr[BT_ADDR_LE_STR_LEN] = { 0 };
    struct uart_data_t *tx = NULL;
 
+#if CONFIG_BLE_FAILSAFE
+   // Any data from the central counts as a keepalive
+   ble_failsafe_feed();
+#endif
+
    bt_addr_le_to_str(bt_conn_get_dst(conn), addr, ARRAY_SIZE(addr));
 
    LOG_INF("Received data from: %s", addr);
@@ -0,0 +1,165 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       bus_lib.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Event bus between the vehicle modules.
+ *
+ *             Observers are zbus listeners that only submit a work item, so a publish
+ *             costs the publisher a few queue operations whatever the observers do. The
+ *             work items run on the bus workqueue in submission order; a work item that is
+ *             still queued is not queued again, which coalesces bursts of publishes.
+ *
+ *             Every work item is timed: the queueing delay runs from when the item was due
+ *             (submitted, or its delay elapsed) to when its handler starts, the execution
+ *             time covers the handler.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/zbus/zbus.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <lib/bus/bus_lib.h>
+
+LOG_MODULE_REGISTER(LOG_BUS_LIB);
+
+
+ZBUS_CHAN_DEFINE(bus_drive_chan, struct bus_drive_state, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+   ZBUS_MSG_INIT(.throttle_permille = 0, .steering_pos = 0));
+ZBUS_CHAN_DEFINE(bus_link_chan, struct bus_link_state, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+   ZBUS_MSG_INIT(.connected = false));
+ZBUS_CHAN_DEFINE(bus_bat_chan, struct bus_bat_state, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+   ZBUS_MSG_INIT(.status = 0));
+ZBUS_CHAN_DEFINE(bus_lights_chan, struct bus_lights_state, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+   ZBUS_MSG_INIT(.scenes = 0));
+
+static K_THREAD_STACK_DEFINE(bus_wq_stack, CONFIG_BUS_LIB_WQ_STACK_SIZE);
+static struct k_work_q bus_wq;
+static bool bus_started = false;
+static struct k_spinlock bus_lock;
+
+
+int32_t bus_lib_init(void)
+{
+   const struct k_work_queue_config cfg = {
+      .name = "bus_wq",
+   };
+
+   if (bus_started) {
+      return 0;
+   }
+
+   k_work_queue_init(&bus_wq);
+   k_work_queue_start(&bus_wq, bus_wq_stack, K_THREAD_STACK_SIZEOF(bus_wq_stack),
+      CONFIG_BUS_LIB_WQ_PRIORITY, &cfg);
+   bus_started = true;
+
+   return 0;
+}
+
+int32_t bus_lib_observe(const struct zbus_channel *chan, const struct zbus_observer *obs)
+{
+   int32_t ret = zbus_chan_add_obs(chan, obs, BUS_LIB_PUB_TIMEOUT);
+
+   if (ret != 0)
+   {
+      LOG_ERR("Failed to attach observer, err: %d", ret);
+      return ret;
+   }
+
+   return 0;
+}
+
+int32_t bus_lib_pub(const struct zbus_channel *chan, const void *msg)
+{
+   int32_t ret = zbus_chan_pub(chan, msg, BUS_LIB_PUB_TIMEOUT);
+
+   if (ret != 0)
+   {
+      LOG_ERR("Failed to publish, err: %d", ret);
+      return ret;
+   }
+
+   return 0;
+}
+
+void bus_lib_work_run(struct k_work *item)
+{
+   struct k_work_delayable *dwork = k_work_delayable_from_work(item);
+   struct bus_lib_work *work = CONTAINER_OF(dwork, struct bus_lib_work, dwork);
+   struct bus_lib_work_stats *stats = &work->stats;
+   int64_t due, start, end;
+
+   k_spinlock_key_t key = k_spin_lock(&bus_lock);
+   due = work->due;
+   k_spin_unlock(&bus_lock, key);
+
+   start = k_uptime_ticks();
+   work->handler(item);
+   end = k_uptime_ticks();
+
+   key = k_spin_lock(&bus_lock);
+   stats->runs++;
+   stats->queue_us_last = k_ticks_to_us_ceil32(MAX(start - due, 0));
+   stats->queue_us_max = MAX(stats->queue_us_max, stats->queue_us_last);
+   stats->exec_us_last = k_ticks_to_us_ceil32(end - start);
+   stats->exec_us_max = MAX(stats->exec_us_max, stats->exec_us_last);
+   k_spin_unlock(&bus_lock, key);
+}
+
+int32_t bus_lib_submit(struct bus_lib_work *work)
+{
+   // Locked so that the workqueue cannot run the item before its due time is set
+   k_spinlock_key_t key = k_spin_lock(&bus_lock);
+   int32_t ret = k_work_schedule_for_queue(&bus_wq, &work->dwork, K_NO_WAIT);
+
+   if (ret == 1) {
+      work->due = k_uptime_ticks();
+   }
+   k_spin_unlock(&bus_lock, key);
+
+   return (ret < 0) ? ret : 0;
+}
+
+int32_t bus_lib_schedule(struct bus_lib_work *work, k_timeout_t delay)
+{
+   k_spinlock_key_t key = k_spin_lock(&bus_lock);
+   int32_t ret = k_work_reschedule_for_queue(&bus_wq, &work->dwork, delay);
+
+   if (ret >= 0) {
+      work->due = k_uptime_ticks() + delay.ticks;
+   }
+   k_spin_unlock(&bus_lock, key);
+
+   return (ret < 0) ? ret : 0;
+}
+
+void bus_lib_cancel(struct bus_lib_work *work)
+{
+   (void)k_work_cancel_delayable(&work->dwork);
+}
+
+void bus_lib_work_get_stats(struct bus_lib_work *work, struct bus_lib_work_stats *stats)
+{
+   k_spinlock_key_t key = k_spin_lock(&bus_lock);
+   *stats = work->stats;
+   k_spin_unlock(&bus_lock, key);
+}
+
+void bus_lib_work_reset_stats(void)
+{
+   k_spinlock_key_t key = k_spin_lock(&bus_lock);
+   STRUCT_SECTION_FOREACH(bus_lib_work, work)
+   {
+      memset(&work->stats, 0, sizeof(work->stats));
+   }
+   k_spin_unlock(&bus_lock, key);
+}
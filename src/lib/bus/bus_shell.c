@@ -0,0 +1,51 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       bus_shell.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Shell for the event bus.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <lib/misc/shell_lib.h>
+#include <lib/bus/bus_lib.h>
+
+
+static int32_t cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+   struct bus_lib_work_stats stats;
+
+   if (argc > 1)
+   {
+      if (strcmp(argv[1], "reset") != 0)
+      {
+         shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+         return -EINVAL;
+      }
+      bus_lib_work_reset_stats();
+      return 0;
+   }
+
+   STRUCT_SECTION_FOREACH(bus_lib_work, work)
+   {
+      bus_lib_work_get_stats(work, &stats);
+      shell_lib_print(sh, "%s: runs: %d, queue last/max: %d/%d us, exec last/max: %d/%d us", 
+         work->name, stats.runs, stats.queue_us_last, stats.queue_us_max, 
+         stats.exec_us_last, stats.exec_us_max);
+   }
+
+   return 0;
+}
+
+
+SHELL_STATIC_SUBCMD_SET_CREATE(bus_cmd,
+	SHELL_CMD_ARG(stats, NULL, "bus stats [reset]", cmd_stats, 1, 1),
+	SHELL_SUBCMD_SET_END // Array terminated
+);
+SHELL_CMD_REGISTER(bus, &bus_cmd, "Event bus cmds", NULL);
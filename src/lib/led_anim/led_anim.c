@@ -0,0 +1,377 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       led_anim.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      LED animation engine.
+ *
+ *             A dedicated thread composites the layers bottom to top at
+ *             CONFIG_LED_ANIM_FRAME_RATE_HZ. Frame times are computed from the first frame
+ *             of a run (absolute), so the cadence does not drift with the time spent
+ *             writing to the device or with preemption; frames that could not start in
+ *             time are skipped rather than played late. The thread sleeps while no layer
+ *             can change the output, i.e., when every playing timeline holds its end.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+
+#include <errno.h>
+#include <string.h>
+
+#include <driver/led_drivers/led_drivers.h>
+#include <lib/led_anim/led_anim.h>
+
+LOG_MODULE_REGISTER(LOG_LED_ANIM);
+
+
+// Unchanged channels between two changed ones are written along with them when there are
+// at most this many, cheaper than the address overhead of another write
+#define LED_ANIM_RUN_GAP_MAX     2
+
+struct led_anim_layer {
+   const struct led_anim_timeline *timeline; // NULL when stopped
+   int64_t start;                            // Uptime in ticks the timeline started at
+   uint32_t gen;                             // Incremented on every play and stop
+};
+
+
+static const struct device *anim_dev;
+static const struct led_anim_timeline *anim_timelines;
+static size_t anim_timeline_cnt;
+static struct k_spinlock anim_lock;
+static struct led_anim_layer anim_layers[CONFIG_LED_ANIM_LAYERS];
+static bool anim_sync;
+static struct led_anim_stats anim_stats;
+static K_SEM_DEFINE(anim_kick, 0, 1);
+static uint8_t anim_last[CONFIG_LED_ANIM_CHANNELS];   // Levels last written, thread only
+
+
+static int64_t led_anim_frame_ticks(uint32_t frame)
+{
+   return ((int64_t)frame * CONFIG_SYS_CLOCK_TICKS_PER_SEC) / CONFIG_LED_ANIM_FRAME_RATE_HZ;
+}
+
+static uint8_t led_anim_track_lvl(const struct led_anim_track *track, uint32_t t_ms)
+{
+   const struct led_anim_key *keys = track->keys;
+   uint8_t i = 0;
+
+   if ((track->key_cnt == 0) || (t_ms < keys[0].t_ms)) {
+      return LED_ANIM_LVL_NONE;
+   }
+
+   // Last key at or before t
+   while (((i + 1) < track->key_cnt) && (keys[i + 1].t_ms <= t_ms)) {
+      i++;
+   }
+   if (((i + 1) == track->key_cnt) || (keys[i].lvl == LED_ANIM_LVL_NONE) ||
+         (keys[i + 1].lvl == LED_ANIM_LVL_NONE)) {
+      return keys[i].lvl;
+   }
+
+   // keys[i].t_ms <= t_ms < keys[i + 1].t_ms
+   return keys[i].lvl + (((int32_t)keys[i + 1].lvl - keys[i].lvl) *
+      (int32_t)(t_ms - keys[i].t_ms)) / (keys[i + 1].t_ms - keys[i].t_ms);
+}
+
+static void led_anim_layer_end(uint8_t layer, uint32_t gen)
+{
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   // Unless played again or stopped in the meantime
+   if (anim_layers[layer].gen == gen) {
+      anim_layers[layer].timeline = NULL;
+   }
+   k_spin_unlock(&anim_lock, key);
+}
+
+static bool led_anim_compose(int64_t frame_tick, uint8_t *out)
+{
+   struct led_anim_layer layers[CONFIG_LED_ANIM_LAYERS];
+   bool running = false;
+
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   memcpy(layers, anim_layers, sizeof(layers));
+   k_spin_unlock(&anim_lock, key);
+
+   // Channels no layer has a level for are off
+   memset(out, 0, CONFIG_LED_ANIM_CHANNELS);
+   for (uint8_t l = 0; l < CONFIG_LED_ANIM_LAYERS; l++)
+   {
+      const struct led_anim_timeline *timeline = layers[l].timeline;
+      uint32_t t_ms = 0;
+
+      if (timeline == NULL) {
+         continue;
+      }
+      if (frame_tick > layers[l].start) {
+         t_ms = k_ticks_to_ms_floor64(frame_tick - layers[l].start);
+      }
+
+      if ((t_ms < timeline->duration_ms) || (timeline->flags & LED_ANIM_F_LOOP))
+      {
+         running = true;
+         if (timeline->flags & LED_ANIM_F_LOOP) {
+            t_ms %= timeline->duration_ms;
+         }
+      }
+      else if (timeline->flags & LED_ANIM_F_HOLD) {
+         t_ms = timeline->duration_ms;
+      }
+      else
+      {
+         led_anim_layer_end(l, layers[l].gen);
+         continue;
+      }
+
+      for (uint8_t i = 0; i < timeline->track_cnt; i++)
+      {
+         const struct led_anim_track *track = &timeline->tracks[i];
+         uint8_t lvl = led_anim_track_lvl(track, t_ms);
+
+         if (lvl != LED_ANIM_LVL_NONE) {
+            out[track->channel] = lvl;
+         }
+      }
+   }
+
+   return running;
+}
+
+static void led_anim_output(const uint8_t *out)
+{
+   uint32_t writes = 0, channels = 0;
+   uint8_t ch = 0;
+
+   while (ch < CONFIG_LED_ANIM_CHANNELS)
+   {
+      uint8_t first, end;
+
+      if (out[ch] == anim_last[ch])
+      {
+         ch++;
+         continue;
+      }
+
+      // One write per run of changed channels, end is exclusive
+      first = ch;
+      end = ch + 1;
+      for (uint8_t i = end; i < CONFIG_LED_ANIM_CHANNELS; i++)
+      {
+         if (out[i] != anim_last[i]) {
+            end = i + 1;
+         }
+         else if ((i - end) >= LED_ANIM_RUN_GAP_MAX) {
+            break;
+         }
+      }
+
+      // Failed channels are written again with the next frame
+      if (led_drivers_set_leds(anim_dev, first, end - first, &out[first]) == 0) {
+         memcpy(&anim_last[first], &out[first], end - first);
+      }
+      writes++;
+      channels += end - first;
+      ch = end;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   anim_stats.writes += writes;
+   anim_stats.channels_written += channels;
+   k_spin_unlock(&anim_lock, key);
+}
+
+static void led_anim_thread(void *p1, void *p2, void *p3)
+{
+   ARG_UNUSED(p1);
+   ARG_UNUSED(p2);
+   ARG_UNUSED(p3);
+   uint8_t out[CONFIG_LED_ANIM_CHANNELS];
+   uint32_t frame, skipped, late_us;
+   int64_t base, sched, now;
+   bool running, sync;
+
+   for (;;)
+   {
+      // Idle until a layer is played or stopped, or the output must be synced
+      k_sem_take(&anim_kick, K_FOREVER);
+      base = k_uptime_ticks();
+      frame = 0;
+
+      do
+      {
+         sched = base + led_anim_frame_ticks(frame);
+         late_us = k_ticks_to_us_ceil32(MAX(k_uptime_ticks() - sched, 0));
+
+         k_spinlock_key_t key = k_spin_lock(&anim_lock);
+         sync = anim_sync;
+         anim_sync = false;
+         k_spin_unlock(&anim_lock, key);
+         if (sync) {
+            memset(anim_last, LED_ANIM_LVL_NONE, sizeof(anim_last));
+         }
+
+         running = led_anim_compose(sched, out);
+         led_anim_output(out);
+
+         // Next frame from the first one, skipping those that can no longer start in time
+         frame++;
+         skipped = 0;
+         now = k_uptime_ticks();
+         while ((base + led_anim_frame_ticks(frame)) <= now)
+         {
+            frame++;
+            skipped++;
+         }
+
+         key = k_spin_lock(&anim_lock);
+         anim_stats.frames++;
+         anim_stats.frames_skipped += skipped;
+         anim_stats.late_us_max = MAX(anim_stats.late_us_max, late_us);
+         k_spin_unlock(&anim_lock, key);
+
+         if (running) {
+            k_sleep(K_TIMEOUT_ABS_TICKS(base + led_anim_frame_ticks(frame)));
+         }
+      } while (running);
+   }
+}
+
+K_THREAD_DEFINE(led_anim_thread_id, CONFIG_LED_ANIM_STACK_SIZE, led_anim_thread, NULL, NULL,
+   NULL, CONFIG_LED_ANIM_THREAD_PRIORITY, 0, 0);
+
+int32_t led_anim_init(const struct device *dev, const struct led_anim_timeline *timelines,
+   size_t count)
+{
+   if (!device_is_ready(dev))
+   {
+      LOG_ERR("LED drivers device %s is not ready", dev->name);
+      return -ENODEV;
+   }
+
+   // Device registers are 0 after reset
+   memset(anim_last, 0, sizeof(anim_last));
+   anim_timelines = timelines;
+   anim_timeline_cnt = count;
+   anim_dev = dev;
+
+   return 0;
+}
+
+const struct led_anim_timeline *led_anim_find(const char *name)
+{
+   for (size_t i = 0; i < anim_timeline_cnt; i++)
+   {
+      if (strcmp(anim_timelines[i].name, name) == 0) {
+         return &anim_timelines[i];
+      }
+   }
+
+   return NULL;
+}
+
+static int32_t led_anim_change_check(const struct led_anim_change *change)
+{
+   const struct led_anim_timeline *timeline = change->timeline;
+   // Stopping is always possible, playing needs a device and a looping timeline a length
+   bool play_invalid = (timeline != NULL) && ((anim_dev == NULL) ||
+      ((timeline->flags & LED_ANIM_F_LOOP) && (timeline->duration_ms == 0)));
+
+   if ((change->layer >= CONFIG_LED_ANIM_LAYERS) || play_invalid)
+   {
+      LOG_ERR("Invalid parameter, layer: %d", (int32_t)change->layer);
+      return -EINVAL;
+   }
+   for (uint8_t i = 0; (timeline != NULL) && (i < timeline->track_cnt); i++)
+   {
+      if (timeline->tracks[i].channel >= CONFIG_LED_ANIM_CHANNELS)
+      {
+         LOG_ERR("Invalid channel %d in timeline %s", (int32_t)timeline->tracks[i].channel,
+            timeline->name);
+         return -EINVAL;
+      }
+   }
+
+   return 0;
+}
+
+int32_t led_anim_apply(const struct led_anim_change *changes, size_t count)
+{
+   int64_t now = k_uptime_ticks();
+
+   if (count == 0) {
+      return 0;
+   }
+   for (size_t i = 0; i < count; i++)
+   {
+      if (led_anim_change_check(&changes[i]) != 0) {
+         return -EINVAL;
+      }
+   }
+
+   // One lock for all of them, the compositor sees either none or every change
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   for (size_t i = 0; i < count; i++)
+   {
+      struct led_anim_layer *layer = &anim_layers[changes[i].layer];
+
+      layer->timeline = changes[i].timeline;
+      layer->start = now;
+      layer->gen++;
+   }
+   k_spin_unlock(&anim_lock, key);
+   k_sem_give(&anim_kick);
+
+   for (size_t i = 0; i < count; i++)
+   {
+      LOG_DBG("Layer %d %s %s", (int32_t)changes[i].layer, 
+         (changes[i].timeline != NULL) ? "playing" : "stopped", 
+         (changes[i].timeline != NULL) ? changes[i].timeline->name : "");
+   }
+
+   return 0;
+}
+
+int32_t led_anim_play(uint8_t layer, const struct led_anim_timeline *timeline)
+{
+   const struct led_anim_change change = { .layer = layer, .timeline = timeline };
+
+   if (timeline == NULL)
+   {
+      LOG_ERR("Invalid parameter, layer: %d", (int32_t)layer);
+      return -EINVAL;
+   }
+
+   return led_anim_apply(&change, 1);
+}
+
+int32_t led_anim_stop(uint8_t layer)
+{
+   const struct led_anim_change change = { .layer = layer, .timeline = NULL };
+
+   return led_anim_apply(&change, 1);
+}
+
+void led_anim_sync(void)
+{
+   if (anim_dev == NULL) {
+      return;
+   }
+
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   anim_sync = true;
+   k_spin_unlock(&anim_lock, key);
+   k_sem_give(&anim_kick);
+}
+
+void led_anim_get_stats(struct led_anim_stats *stats)
+{
+   k_spinlock_key_t key = k_spin_lock(&anim_lock);
+   *stats = anim_stats;
+   k_spin_unlock(&anim_lock, key);
+}
@@ -0,0 +1,96 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       led_anim_shell.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Shell for the LED animation engine.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <lib/misc/shell_lib.h>
+#include <lib/led_anim/led_anim.h>
+
+
+static int32_t cmd_play(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   const struct led_anim_timeline *timeline;
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_layer = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_layer >= CONFIG_LED_ANIM_LAYERS))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   timeline = led_anim_find(argv[2]);
+   if (timeline == NULL)
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+
+   ret = led_anim_play(arg_layer, timeline);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_stop(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   uint32_t arg_layer = strtoul(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_layer >= CONFIG_LED_ANIM_LAYERS))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+
+   ret = led_anim_stop(arg_layer);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+   return 0;
+}
+
+static int32_t cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   struct led_anim_stats stats;
+
+   led_anim_get_stats(&stats);
+   shell_lib_print(sh, "frames: %d, skipped: %d, late max: %d us", stats.frames, 
+      stats.frames_skipped, stats.late_us_max);
+   shell_lib_print(sh, "writes: %d, channels written: %d", stats.writes, 
+      stats.channels_written);
+
+   return 0;
+}
+
+
+SHELL_STATIC_SUBCMD_SET_CREATE(led_anim_cmd,
+	SHELL_CMD_ARG(play, NULL, "led_anim play [layer] [timeline]", cmd_play, 3, 0),
+	SHELL_CMD_ARG(stop, NULL, "led_anim stop [layer]", cmd_stop, 2, 0),
+	SHELL_CMD_ARG(stats, NULL, "led_anim stats", cmd_stats, 1, 0),
+	SHELL_SUBCMD_SET_END // Array terminated
+);
+SHELL_CMD_REGISTER(led_anim, &led_anim_cmd, "LED animation cmds", NULL);
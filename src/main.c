@@ -15,7 +15,7 @@
 #include <zephyr/logging/log.h>
 
 #include <lib/misc/soc_lib.h>
-#include <profile/tinyrc.h>
+#include <profile/profile.h>
 
 LOG_MODULE_REGISTER(LOG_MAIN);
 
@@ -25,7 +25,8 @@ int32_t main(void)
    // NOTE: init functions do not return if error occurs!
    soc_lib_init();
 
-   tinyrc_init();
+   // Profile picked from settings, or the default one
+   (void)profile_init();
 
    for (;;) {
       k_sleep(K_MSEC(1000));
@@ -0,0 +1,152 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       profile.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Vehicle profile registry.
+ *
+ *             Profiles are const entries of an iterable section, they cost flash only. The
+ *             running profile gets its state in one arena sized for the largest profile
+ *             (CONFIG_PROFILE_RAM_SIZE, checked at build time by PROFILE_DEFINE()).
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#if CONFIG_PROFILE_SETTINGS
+#include <zephyr/settings/settings.h>
+#endif
+
+#include <errno.h>
+#include <string.h>
+
+#include <profile/profile.h>
+
+LOG_MODULE_REGISTER(LOG_PROFILE);
+
+
+static uint8_t profile_arena[CONFIG_PROFILE_RAM_SIZE] __aligned(8);
+static const struct profile *profile_active;
+#if CONFIG_PROFILE_SETTINGS
+static char profile_name[PROFILE_NAME_LEN_MAX + 1];   // Stored selection, "" if none
+
+
+static int profile_settings_set(const char *key, size_t len, settings_read_cb read_cb, 
+   void *cb_arg)
+{
+   const char *next;
+   ssize_t ret;
+
+   if (!settings_name_steq(key, "name", &next) || (next != NULL)) {
+      return -ENOENT;
+   }
+   if (len > PROFILE_NAME_LEN_MAX) {
+      return -EINVAL;
+   }
+
+   ret = read_cb(cb_arg, profile_name, len);
+   if (ret < 0) {
+      return ret;
+   }
+   profile_name[ret] = '\0';
+
+   return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(profile, "profile", NULL, profile_settings_set, NULL, NULL);
+#endif
+
+
+const struct profile *profile_find(const char *name)
+{
+   STRUCT_SECTION_FOREACH(profile, profile)
+   {
+      if (strcmp(profile->name, name) == 0) {
+         return profile;
+      }
+   }
+
+   return NULL;
+}
+
+const struct profile *profile_get(void)
+{
+   return profile_active;
+}
+
+int32_t profile_select(const char *name)
+{
+#if CONFIG_PROFILE_SETTINGS
+   int32_t ret = 0;
+
+   if (profile_find(name) == NULL) {
+      return -ENOENT;
+   }
+
+   ret = settings_save_one("profile/name", name, strlen(name));
+   if (ret != 0)
+   {
+      LOG_ERR("Failed to store the profile, err: %d", ret);
+      return ret;
+   }
+
+   return 0;
+#else
+   ARG_UNUSED(name);
+
+   return -ENOTSUP;
+#endif
+}
+
+int32_t profile_init(void)
+{
+   const char *name = CONFIG_PROFILE_DEFAULT;
+   const struct profile *profile;
+   int32_t ret = 0;
+   size_t cnt = 0;
+
+   STRUCT_SECTION_COUNT(profile, &cnt);
+   if (cnt == 0)
+   {
+      LOG_ERR("No profile linked in");
+      return -ENOENT;
+   }
+
+#if CONFIG_PROFILE_SETTINGS
+   ret = settings_subsys_init();
+   if (ret == 0) {
+      ret = settings_load_subtree("profile");
+   }
+   if (ret != 0) {
+      LOG_WRN("Failed to load the profile setting, err: %d", ret);
+   }
+   else if (profile_name[0] != '\0') {
+      name = profile_name;
+   }
+#endif
+
+   profile = profile_find(name);
+   if (profile == NULL)
+   {
+      STRUCT_SECTION_GET(profile, 0, &profile);
+      LOG_WRN("No profile %s, running %s", name, profile->name);
+   }
+
+   // The arena is only ever given to this profile
+   memset(profile_arena, 0, profile->ram_size);
+   ret = profile->init((profile->ram_size > 0) ? profile_arena : NULL);
+   if (ret != 0)
+   {
+      LOG_ERR("Failed to init profile %s, err: %d", profile->name, ret);
+      return ret;
+   }
+   profile_active = profile;
+
+   LOG_INF("Running profile %s", profile->name);
+
+   return 0;
+}
@@ -0,0 +1,106 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       profile_shell.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Shell for the vehicle profiles.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <lib/misc/shell_lib.h>
+#include <profile/profile.h>
+
+
+static int32_t cmd_list(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   const struct profile *active = profile_get();
+
+   STRUCT_SECTION_FOREACH(profile, profile)
+   {
+      shell_lib_print(sh, "%c %s (RAM: %d bytes)", (profile == active) ? '*' : ' ', 
+         profile->name, profile->ram_size);
+   }
+
+   return 0;
+}
+
+static int32_t cmd_info(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   ARG_UNUSED(argv);
+   const struct profile *profile = profile_get();
+
+   if (profile == NULL)
+   {
+      shell_lib_error(sh, "No profile running");
+      return -ENOENT;
+   }
+
+   shell_lib_print(sh, "%s, throttle max: %d permille, steering max: %d steps", profile->name, 
+      profile->motor_limits->throttle_permille_max, profile->motor_limits->steering_pos_max);
+   for (uint8_t i = 0; i < profile->led_map->cnt; i++) {
+      shell_lib_print(sh, "LED %d: %s", (int32_t)i, profile->led_map->names[i]);
+   }
+
+   return 0;
+}
+
+static int32_t cmd_select(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+
+   ret = profile_select(argv[1]);
+   if (ret == -ENOENT)
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   else if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+   shell_lib_print(sh, "%s runs from the next boot", argv[1]);
+
+   return 0;
+}
+
+// Commands of the running profile, none before it is running
+static void profile_cmds_get(size_t idx, struct shell_static_entry *entry)
+{
+   const struct profile *profile = profile_get();
+
+   entry->syntax = NULL;
+   if ((profile == NULL) || (profile->cmds == NULL)) {
+      return;
+   }
+   for (size_t i = 0; i <= idx; i++)
+   {
+      if (profile->cmds[i].syntax == NULL) {
+         return;
+      }
+   }
+
+   *entry = profile->cmds[idx];
+}
+
+
+SHELL_STATIC_SUBCMD_SET_CREATE(profile_cmd,
+	SHELL_CMD_ARG(list, NULL, "profile list", cmd_list, 1, 0),
+	SHELL_CMD_ARG(info, NULL, "profile info (running profile)", cmd_info, 1, 0),
+	SHELL_CMD_ARG(select, NULL, "profile select [name] (from the next boot)", cmd_select, 2, 0),
+	SHELL_SUBCMD_SET_END // Array terminated
+);
+SHELL_CMD_REGISTER(profile, &profile_cmd, "Vehicle profile cmds", NULL);
+
+SHELL_DYNAMIC_CMD_CREATE(profile_run_cmd, profile_cmds_get);
+SHELL_CMD_REGISTER(rc, &profile_run_cmd, "Running profile cmds", NULL);
@@ -10,260 +10,653 @@
  * @brief      Profile for tinyRC.
  */
 
+#include <zephyr/sys/atomic.h>
 #include <zephyr/logging/log.h>
 
+#include <stdlib.h>
+#include <string.h>
+
+#include <profile/profile.h>
 #include <profile/tinyrc.h>
 #include <driver/led_drivers/ltc3220.h>
 #include <driver/led_drivers/led_drivers.h>
+#include <driver/motors/motors_drv.h>
+#include <driver/bat_charger/bat_charger.h>
+#include <lib/bus/bus_lib.h>
+#if CONFIG_BLE_FAILSAFE
+#include <lib/ble/ble_failsafe.h>
+#endif
+#if !CONFIG_TINYRC_LED_HW_BLINK
+#include <lib/led_anim/led_anim.h>
+#endif
 
 LOG_MODULE_REGISTER(LOG_TINYRC);
 
 
 static const struct device *dev_led_drivers = DEVICE_DT_GET_ONE(adi_ltc3220);
+static const struct device *dev_motors_drv = DEVICE_DT_GET(DT_ALIAS(motors0));
+static const struct device *dev_bat_charger = DEVICE_DT_GET(DT_ALIAS(mcp73831));
+
+static const char *const tinyrc_led_names[] = {
+   [TINYRC_LED_RED_B_L] = "red_b_l", [TINYRC_LED_BLU_B_L] = "blu_b_l", 
+   [TINYRC_LED_GRE_B_L] = "gre_b_l", [TINYRC_LED_RED_B_C] = "red_b_c", 
+   [TINYRC_LED_BLU_B_C] = "blu_b_c", [TINYRC_LED_GRE_B_C] = "gre_b_c", 
+   [TINYRC_LED_RED_B_R] = "red_b_r", [TINYRC_LED_BLU_B_R] = "blu_b_r", 
+   [TINYRC_LED_GRE_B_R] = "gre_b_r", [TINYRC_LED_RED_F_R] = "red_f_r", 
+   [TINYRC_LED_BLU_F_R] = "blu_f_r", [TINYRC_LED_GRE_F_R] = "gre_f_r", 
+   [TINYRC_LED_RED_F_C] = "red_f_c", [TINYRC_LED_BLU_F_C] = "blu_f_c", 
+   [TINYRC_LED_GRE_F_C] = "gre_f_c", [TINYRC_LED_RED_F_L] = "red_f_l", 
+   [TINYRC_LED_BLU_F_L] = "blu_f_l", [TINYRC_LED_GRE_F_L] = "gre_f_l", 
+};
+
+BUILD_ASSERT(ARRAY_SIZE(tinyrc_led_names) == LTC3220_TOTAL_LEDS, "One name per LED");
+
+static const struct profile_led_map tinyrc_led_map = {
+   .names = tinyrc_led_names,
+   .cnt = ARRAY_SIZE(tinyrc_led_names),
+};
+
+static const struct profile_motor_limits tinyrc_motor_limits = {
+   .throttle_permille_max = TINYRC_THROTTLE_PERMILLE_MAX,
+   .steering_pos_max = TINYRC_STEERING_POS_MAX,
+};
+
+// LED scenes from bottom to top, a higher scene covers the LEDs it lights
+enum TINYRC_SCENE {
+   TINYRC_SCENE_DEFAULT = 0,
+   TINYRC_SCENE_REVERSE,
+   TINYRC_SCENE_BRAKE,
+   TINYRC_SCENE_BLINKER_L,
+   TINYRC_SCENE_BLINKER_R,
+   TINYRC_SCENE_ALL_ON,
+   TINYRC_SCENE_CNT,
+};
+
+// LEDs lit by each scene, X(led, colour, brightness percentage, arg) per LED. The LED 
+// tables of both LED paths are built from these at compile time
+#define TINYRC_SCENE_LEDS_DEFAULT(X, arg)                                          \
+   X(TINYRC_LED_RED_F_R, RED, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_BLU_F_R, BLU, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_GRE_F_R, GRE, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_RED_F_C, RED, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_BLU_F_C, BLU, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_GRE_F_C, GRE, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_RED_F_L, RED, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_BLU_F_L, BLU, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_GRE_F_L, GRE, TINYRC_LED_BRI_DEFAULT_FRONT, arg)                   \
+   X(TINYRC_LED_RED_B_L, RED, TINYRC_LED_BRI_DEFAULT_BACK, arg)                    \
+   X(TINYRC_LED_RED_B_C, RED, TINYRC_LED_BRI_DEFAULT_BACK, arg)                    \
+   X(TINYRC_LED_RED_B_R, RED, TINYRC_LED_BRI_DEFAULT_BACK, arg)
+#define TINYRC_SCENE_LEDS_REVERSE(X, arg)                                          \
+   X(TINYRC_LED_RED_B_C, RED, TINYRC_LED_BRI_REVERSE, arg)                         \
+   X(TINYRC_LED_BLU_B_C, BLU, TINYRC_LED_BRI_REVERSE, arg)                         \
+   X(TINYRC_LED_GRE_B_C, GRE, TINYRC_LED_BRI_REVERSE, arg)
+#define TINYRC_SCENE_LEDS_BRAKE(X, arg)                                            \
+   X(TINYRC_LED_RED_B_L, RED, TINYRC_LED_BRI_BRAKE, arg)                           \
+   X(TINYRC_LED_RED_B_C, RED, TINYRC_LED_BRI_BRAKE, arg)                           \
+   X(TINYRC_LED_RED_B_R, RED, TINYRC_LED_BRI_BRAKE, arg)
+#define TINYRC_SCENE_LEDS_BLINKER_L(X, arg)                                        \
+   X(TINYRC_LED_RED_F_L, RED, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_BLU_F_L, BLU, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_GRE_F_L, GRE, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_RED_B_L, RED, TINYRC_LED_BRI_BLINKER_BACK, arg)
+#define TINYRC_SCENE_LEDS_BLINKER_R(X, arg)                                        \
+   X(TINYRC_LED_RED_F_R, RED, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_BLU_F_R, BLU, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_GRE_F_R, GRE, TINYRC_LED_BRI_BLINKER_FRONT, arg)                   \
+   X(TINYRC_LED_RED_B_R, RED, TINYRC_LED_BRI_BLINKER_BACK, arg)
 
-typedef struct work_info {
-    struct k_work_delayable work;
-    struct k_mutex lock;
-} work_info_t;
+#define TINYRC_SCENE_BLINKERS          (BIT(TINYRC_SCENE_BLINKER_L) | BIT(TINYRC_SCENE_BLINKER_R))
 
-static work_info_t blinker_work;
-static volatile bool blinker_toggle = false;
-static bool led_def_enabled = false;
-static volatile bool blinker_left_enabled = false, blinker_right_enabled = false;
+// Profile state, in the profile RAM arena while tinyRC is the running profile
+struct tinyrc_ram {
+   // Lighting state shared by the shell, BLE and the blinkers. Callers only change the 
+   // state word; whoever finds no output in progress turns it into LED output, until the 
+   // state it last output is the latest one. No locks are taken, and every output is of 
+   // one whole state
+   atomic_t scene_state;            // BIT(TINYRC_SCENE_*) of the scenes to show
+   atomic_t scene_requests;         // Outputs requested since the output started
+   uint32_t scene_shown;            // BIT(TINYRC_SCENE_*) last output, output only
+#if CONFIG_TINYRC_LED_HW_BLINK
+   uint8_t scene_img[LTC3220_TOTAL_LEDS]; // Image last written, output only
+#endif
+   struct bus_drive_state drive_last;     // Drive state last followed, bus workqueue only
+#if CONFIG_TINYRC_LINK_HAZARD
+   uint32_t hazard_set;             // Blinkers the link loss turned on, bus workqueue only
+#endif
+};
 
-static void blinker_work_cb(struct k_work *item)
+static struct tinyrc_ram *ram;         // NULL unless tinyRC is the running profile
+
+#if CONFIG_TINYRC_LED_HW_BLINK
+struct tinyrc_scene {
+   uint32_t leds;                   // BIT(led) of the LEDs the scene lights
+   uint8_t img[LTC3220_TOTAL_LEDS]; // LED_DRIVERS_IMG() of every LED
+};
+
+#define TINYRC_SCENE_BIT(led, col, per, _)      BIT(led) |
+#define TINYRC_SCENE_IMG(led, col, per, mode)   [led] = LED_DRIVERS_IMG(TINYRC_LED_LVL(col, per), \
+                                                   mode),
+#define TINYRC_SCENE(_leds, _mode)              { .leds = _leds(TINYRC_SCENE_BIT, _) 0, \
+                                                  .img = { _leds(TINYRC_SCENE_IMG, _mode) } }
+#define TINYRC_SCENE_IMG_ON(led, _)             LED_DRIVERS_IMG(LTC3220_LVL_MAX, \
+                                                   LED_DRIVERS_MODE_NORMAL)
+
+// The LED drivers blink on their own, nothing to do for the blinkers once shown
+static const struct tinyrc_scene scenes[TINYRC_SCENE_CNT] = {
+   [TINYRC_SCENE_DEFAULT] = 
+      TINYRC_SCENE(TINYRC_SCENE_LEDS_DEFAULT, LED_DRIVERS_MODE_NORMAL),
+   [TINYRC_SCENE_REVERSE] = 
+      TINYRC_SCENE(TINYRC_SCENE_LEDS_REVERSE, LED_DRIVERS_MODE_NORMAL),
+   [TINYRC_SCENE_BRAKE] = 
+      TINYRC_SCENE(TINYRC_SCENE_LEDS_BRAKE, LED_DRIVERS_MODE_NORMAL),
+   [TINYRC_SCENE_BLINKER_L] = 
+      TINYRC_SCENE(TINYRC_SCENE_LEDS_BLINKER_L, LED_DRIVERS_MODE_BLINK),
+   [TINYRC_SCENE_BLINKER_R] = 
+      TINYRC_SCENE(TINYRC_SCENE_LEDS_BLINKER_R, LED_DRIVERS_MODE_BLINK),
+   [TINYRC_SCENE_ALL_ON] = {
+      .leds = BIT_MASK(LTC3220_TOTAL_LEDS),
+      .img = { LISTIFY(LTC3220_TOTAL_LEDS, TINYRC_SCENE_IMG_ON, (,)) },
+   },
+};
+
+static int32_t scene_update(uint32_t active)
 {
-   if (!blinker_toggle)
-   {
-      blinker_toggle = true;
+   // Fade in when turned on, unless a blinker already owns some of the LEDs
+   const bool fade = (active & BIT(TINYRC_SCENE_DEFAULT)) && 
+      !(ram->scene_shown & BIT(TINYRC_SCENE_DEFAULT)) && !(active & TINYRC_SCENE_BLINKERS);
+   uint8_t img[LTC3220_TOTAL_LEDS] = { 0 };
 
-      if (blinker_left_enabled)
-      {
-         // Front left LEDs
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_L, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_L, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_L, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         // Back left LED
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_L, 
-               TINYRC_LED_BRI_BLINKER_BACK) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
+   // Composite bottom to top, LEDs no scene lights are off
+   for (uint8_t s = 0; s < TINYRC_SCENE_CNT; s++)
+   {
+      if (!(active & BIT(s))) {
+         continue;
       }
-      if (blinker_right_enabled)
+      for (uint8_t led = 0; led < LTC3220_TOTAL_LEDS; led++)
       {
-         // Front right LEDs
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_R, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_R, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_R, 
-               TINYRC_LED_BRI_BLINKER_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
+         if (!(scenes[s].leds & BIT(led))) {
+            continue;
          }
-         // Back right LED
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_R, 
-               TINYRC_LED_BRI_BLINKER_BACK) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
+         img[led] = scenes[s].img[led];
+
+         // The default LEDs stay dark until the gradation is started below, and stay in 
+         // gradation mode after it rather than cost a write to go back to normal
+         if ((s == TINYRC_SCENE_DEFAULT) && (fade || (ram->scene_img[led] == 
+               LED_DRIVERS_IMG(LED_DRIVERS_IMG_LVL(img[led]), LED_DRIVERS_MODE_GRAD)))) {
+            img[led] = LED_DRIVERS_IMG(LED_DRIVERS_IMG_LVL(img[led]), LED_DRIVERS_MODE_GRAD);
          }
       }
    }
-   else
-   {
-      blinker_toggle = false;
 
-      if (blinker_left_enabled)
-      {
-         // Front left LEDs
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_L, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_L, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_L, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         // Back left LED
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_L, 
-               TINYRC_LED_BRI_DEFAULT_BACK) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
+   // One write of the LEDs that changed
+   ram->scene_shown = active;
+   if (led_drivers_set_image(dev_led_drivers, 0, LTC3220_TOTAL_LEDS, img) != 0) {
+      return -EIO;
+   }
+   memcpy(ram->scene_img, img, sizeof(ram->scene_img));
+
+   // The LED drivers ramp the LEDs up on their own
+   if (fade && (led_drivers_set_grad(dev_led_drivers, TINYRC_LED_FADE_MS, true) != 0)) {
+      return -EIO;
+   }
+
+   return 0;
+}
+#else
+// Fades an LED in to lvl, then holds it
+#define TINYRC_ANIM_FADE_IN(led, col, per, _)   LED_ANIM_TRACK(led, { 0, 0 },       \
+   { TINYRC_LED_FADE_MS, TINYRC_LED_LVL(col, per) }),
+// Blinks an LED, the lower layers show through in the off phase
+#define TINYRC_ANIM_BLINK(led, col, per, _)     LED_ANIM_TRACK(led,                 \
+   { 0, TINYRC_LED_LVL(col, per) }, { TINYRC_LED_BLINKER_PERIOD_MS, TINYRC_LED_LVL(col, per) }, \
+   { TINYRC_LED_BLINKER_PERIOD_MS, LED_ANIM_LVL_NONE }),
+// Holds an LED at its scene level
+#define TINYRC_ANIM_ON(led, col, per, _)        LED_ANIM_TRACK(led,                 \
+   { 0, TINYRC_LED_LVL(col, per) }),
+#define TINYRC_ANIM_ALL_ON(led, _)              LED_ANIM_TRACK(led, { 0, LTC3220_LVL_MAX })
+#define TINYRC_ANIM_TIMELINE(_name, _duration_ms, _flags, _tracks)                  \
+   {                                                                       \
+      .name = (_name),                                                     \
+      .duration_ms = (_duration_ms),                                       \
+      .flags = (_flags),                                                   \
+      .track_cnt = ARRAY_SIZE(_tracks),                                    \
+      .tracks = (_tracks),                                                 \
+   }
+
+static const struct led_anim_track anim_default_tracks[] = {
+   TINYRC_SCENE_LEDS_DEFAULT(TINYRC_ANIM_FADE_IN, _)
+};
+static const struct led_anim_track anim_reverse_tracks[] = {
+   TINYRC_SCENE_LEDS_REVERSE(TINYRC_ANIM_ON, _)
+};
+static const struct led_anim_track anim_brake_tracks[] = {
+   TINYRC_SCENE_LEDS_BRAKE(TINYRC_ANIM_ON, _)
+};
+static const struct led_anim_track anim_blinker_l_tracks[] = {
+   TINYRC_SCENE_LEDS_BLINKER_L(TINYRC_ANIM_BLINK, _)
+};
+static const struct led_anim_track anim_blinker_r_tracks[] = {
+   TINYRC_SCENE_LEDS_BLINKER_R(TINYRC_ANIM_BLINK, _)
+};
+static const struct led_anim_track anim_all_on_tracks[] = {
+   LISTIFY(LTC3220_TOTAL_LEDS, TINYRC_ANIM_ALL_ON, (,))
+};
+
+// One timeline per scene, each played on the layer of the same number
+static const struct led_anim_timeline anim_timelines[TINYRC_SCENE_CNT] = {
+   [TINYRC_SCENE_DEFAULT] = TINYRC_ANIM_TIMELINE("default", TINYRC_LED_FADE_MS, 
+      LED_ANIM_F_HOLD, anim_default_tracks),
+   [TINYRC_SCENE_REVERSE] = TINYRC_ANIM_TIMELINE("reverse", 0, LED_ANIM_F_HOLD, 
+      anim_reverse_tracks),
+   [TINYRC_SCENE_BRAKE] = TINYRC_ANIM_TIMELINE("brake", 0, LED_ANIM_F_HOLD, 
+      anim_brake_tracks),
+   [TINYRC_SCENE_BLINKER_L] = TINYRC_ANIM_TIMELINE("blinker_l", 
+      2 * TINYRC_LED_BLINKER_PERIOD_MS, LED_ANIM_F_LOOP, anim_blinker_l_tracks),
+   [TINYRC_SCENE_BLINKER_R] = TINYRC_ANIM_TIMELINE("blinker_r", 
+      2 * TINYRC_LED_BLINKER_PERIOD_MS, LED_ANIM_F_LOOP, anim_blinker_r_tracks),
+   [TINYRC_SCENE_ALL_ON] = TINYRC_ANIM_TIMELINE("all_on", 0, LED_ANIM_F_HOLD, 
+      anim_all_on_tracks),
+};
+
+BUILD_ASSERT(CONFIG_LED_ANIM_LAYERS >= TINYRC_SCENE_CNT, "One LED animation layer per scene");
+
+static int32_t scene_update(uint32_t active)
+{
+   struct led_anim_change changes[TINYRC_SCENE_CNT];
+   size_t count = 0;
+   int32_t ret;
+
+   // Scenes already shown keep playing, playing again would restart a fade
+   for (uint8_t s = 0; s < TINYRC_SCENE_CNT; s++)
+   {
+      if ((active & BIT(s)) == (ram->scene_shown & BIT(s))) {
+         continue;
       }
-      if (blinker_right_enabled)
-      {
-         // Front right LEDs
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_R, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_R, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_R, 
-               TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
-         // Back right LED
-         if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_R, 
-               TINYRC_LED_BRI_DEFAULT_BACK) != 0) {
-            LOG_ERR("Failed led_drivers_set_led()");
-         }
+      changes[count].layer = s;
+      changes[count].timeline = (active & BIT(s)) ? &anim_timelines[s] : NULL;
+      count++;
+   }
+
+   // All at once, e.g., the brake lights never show a frame without the default lights
+   ret = led_anim_apply(changes, count);
+   if (ret == 0) {
+      ram->scene_shown = active;
+   }
+
+   return ret;
+}
+#endif
+
+static int32_t scene_output(void)
+{
+   atomic_val_t requests;
+   struct bus_lights_state lights;
+   int32_t ret = 0;
+
+   // An output in progress picks the new state up before it ends
+   if (atomic_inc(&ram->scene_requests) != 0) {
+      return 0;
+   }
+
+   // Output again if the state changed meanwhile
+   do
+   {
+      requests = atomic_get(&ram->scene_requests);
+      ret = scene_update((uint32_t)atomic_get(&ram->scene_state));
+      if (ret != 0) {
+         LOG_ERR("Failed LED output, ret: %d", ret);
       }
+      lights.scenes = ram->scene_shown;
+   } while (!atomic_cas(&ram->scene_requests, requests, 0));
+
+   (void)bus_lib_pub(&bus_lights_chan, &lights);
+
+   return ret;
+}
+
+static int32_t scene_change(uint32_t set, uint32_t clear)
+{
+   atomic_val_t old;
+
+   if (ram == NULL) {
+      return -ENODEV;
    }
 
-   k_work_reschedule(&blinker_work.work, K_MSEC(TINYRC_LED_BLINKER_PERIOD_MS));
+   do {
+      old = atomic_get(&ram->scene_state);
+   } while (!atomic_cas(&ram->scene_state, old, (old & ~clear) | set));
+
+   return scene_output();
+}
+
+static int32_t scene_set(uint8_t scene, bool enable)
+{
+   return enable ? scene_change(BIT(scene), 0) : scene_change(0, BIT(scene));
 }
 
 int32_t tinyrc_led_set_default(void)
 {
-   led_def_enabled = true;
+   return scene_set(TINYRC_SCENE_DEFAULT, true);
+}
 
-   // Turn all front LEDs to white with default brightness percentage
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_L, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
+int32_t tinyrc_led_set_allonoff(bool on)
+{
+   // Off clears every scene, the driver then shuts the LED drivers down
+   if ((on ? scene_set(TINYRC_SCENE_ALL_ON, true) : 
+         scene_change(0, BIT_MASK(TINYRC_SCENE_CNT))) != 0) {
       return -EIO;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_L, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
+   
+   return 0;
+}
+
+int32_t tinyrc_led_set_blinker(tinyrc_blinker_side_t side, bool enable)
+{
+   const uint8_t scene = (side == TINYRC_BLINKER_LEFT) ? TINYRC_SCENE_BLINKER_L : 
+      TINYRC_SCENE_BLINKER_R;
+
+   LOG_INF("%s blinker state = %d", (side == TINYRC_BLINKER_LEFT) ? "Left" : "Right", 
+      (int32_t)enable);
+
+   // The LEDs below show again once the blinker is disabled
+   return scene_set(scene, enable);
+}
+
+int32_t tinyrc_led_set_brake(bool enable)
+{
+   return scene_set(TINYRC_SCENE_BRAKE, enable);
+}
+
+int32_t tinyrc_led_set_reverse(bool enable)
+{
+   return scene_set(TINYRC_SCENE_REVERSE, enable);
+}
+
+static int32_t tinyrc_drive_pub_stop(void)
+{
+   struct bus_drive_state state;
+
+   // Steering stays where it is
+   if (zbus_chan_read(&bus_drive_chan, &state, BUS_LIB_PUB_TIMEOUT) != 0) {
       return -EIO;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_L, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+   state.throttle_permille = 0;
+
+   return bus_lib_pub(&bus_drive_chan, &state);
+}
+
+int32_t tinyrc_drive(int16_t throttle_permille, int32_t steering_pos)
+{
+   const struct bus_drive_state state = {
+      .throttle_permille = throttle_permille,
+      .steering_pos = steering_pos,
+   };
+   int32_t ret = 0;
+
+   if ((abs(throttle_permille) > tinyrc_motor_limits.throttle_permille_max) || 
+      (abs(steering_pos) > tinyrc_motor_limits.steering_pos_max))
+   {
+      LOG_ERR("Drive outside of the limits, throttle: %d, steering: %d", 
+         (int32_t)throttle_permille, steering_pos);
+      return -EINVAL;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_C, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+
+   ret = motors_drv_drive(dev_motors_drv, throttle_permille, steering_pos);
+   if (ret != 0) {
+      return ret;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_C, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+
+   // Lights and other behaviours follow from the bus
+   return bus_lib_pub(&bus_drive_chan, &state);
+}
+
+int32_t tinyrc_stop(void)
+{
+   int32_t ret = 0;
+
+   ret = motors_drv_move_dc(dev_motors_drv, MOTOR_DIR_FORWARD, 0);
+   if (ret != 0) {
+      return ret;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_C, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+
+   return tinyrc_drive_pub_stop();
+}
+
+static void tinyrc_drive_stopped(struct k_work *work)
+{
+   ARG_UNUSED(work);
+
+   (void)tinyrc_drive_pub_stop();
+}
+
+static BUS_LIB_WORK_DEFINE(tinyrc_drive_stopped_work, tinyrc_drive_stopped);
+
+static void tinyrc_brake_release(struct k_work *work)
+{
+   ARG_UNUSED(work);
+
+   (void)scene_change(0, BIT(TINYRC_SCENE_BRAKE));
+}
+
+static BUS_LIB_WORK_DEFINE(tinyrc_brake_release_work, tinyrc_brake_release);
+
+// Drive state to lights: reverse lights while going backward, brake lights on slowing 
+// down, blinkers on steering. Bus workqueue only
+static void tinyrc_drive_changed(struct k_work *work)
+{
+   ARG_UNUSED(work);
+   struct bus_drive_state state;
+   uint32_t set = 0, clear = 0;
+   uint32_t steer = 0, steer_last = 0;
+
+   if (zbus_chan_read(&bus_drive_chan, &state, BUS_LIB_PUB_TIMEOUT) != 0) {
+      return;
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_F_R, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+
+   if (state.throttle_permille < 0) {
+      set |= BIT(TINYRC_SCENE_REVERSE);
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_BLU_F_R, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+   else {
+      clear |= BIT(TINYRC_SCENE_REVERSE);
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_GRE_F_R, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+
+   if (abs(state.throttle_permille) < abs(ram->drive_last.throttle_permille))
+   {
+      set |= BIT(TINYRC_SCENE_BRAKE);
+      (void)bus_lib_schedule(&tinyrc_brake_release_work, K_MSEC(TINYRC_LED_BRAKE_HOLD_MS));
+   }
+   else if (abs(state.throttle_permille) > abs(ram->drive_last.throttle_permille))
+   {
+      clear |= BIT(TINYRC_SCENE_BRAKE);
+      bus_lib_cancel(&tinyrc_brake_release_work);
    }
 
-   // Turn all back LEDs to red with default brightness percentage
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_L, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+   // Only when the steering crosses a threshold, blinkers set from the shell stay set
+   if (state.steering_pos <= -TINYRC_LED_BLINKER_STEER_POS) {
+      steer = BIT(TINYRC_SCENE_BLINKER_L);
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_C, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+   else if (state.steering_pos >= TINYRC_LED_BLINKER_STEER_POS) {
+      steer = BIT(TINYRC_SCENE_BLINKER_R);
    }
-   if (led_drivers_set_led(dev_led_drivers, TINYRC_LED_RED_B_R, 
-         TINYRC_LED_BRI_DEFAULT_FRONT) != 0) {
-      return -EIO;
+   if (ram->drive_last.steering_pos <= -TINYRC_LED_BLINKER_STEER_POS) {
+      steer_last = BIT(TINYRC_SCENE_BLINKER_L);
+   }
+   else if (ram->drive_last.steering_pos >= TINYRC_LED_BLINKER_STEER_POS) {
+      steer_last = BIT(TINYRC_SCENE_BLINKER_R);
    }
+   if (steer != steer_last)
+   {
+      set |= steer;
+      clear |= steer_last;
+   }
+   ram->drive_last = state;
 
-   return 0;
+   // One output for all of the changes
+   (void)scene_change(set, clear);
 }
 
-int32_t tinyrc_led_set_allonoff(bool on)
+BUS_LIB_OBSERVER_DEFINE(tinyrc_drive_obs, tinyrc_drive_changed);
+
+#if CONFIG_TINYRC_LINK_HAZARD
+// Turns off only the blinkers the link loss turned on, those the user set stay on
+static void tinyrc_hazard_off(struct k_work *work)
 {
-   int32_t ret = 0;
-   const struct ltc3220_config *cfg = dev_led_drivers->config;
+   ARG_UNUSED(work);
+   uint32_t clear = ram->hazard_set;
+
+   ram->hazard_set = 0;
+   if (clear != 0) {
+      (void)scene_change(0, clear);
+   }
+}
+
+static BUS_LIB_WORK_DEFINE(tinyrc_hazard_off_work, tinyrc_hazard_off);
+#endif
+
+// Link state to lights: default lights while the central is connected and, if enabled, 
+// hazard lights for a while after it went away
+static void tinyrc_link_changed(struct k_work *work)
+{
+   ARG_UNUSED(work);
+   struct bus_link_state state;
 
-   if (on)
+   if (zbus_chan_read(&bus_link_chan, &state, BUS_LIB_PUB_TIMEOUT) != 0) {
+      return;
+   }
+
+#if CONFIG_TINYRC_LINK_HAZARD
+   if (!state.connected)
    {
-      for (uint8_t i = 0; i < cfg->led_count; i++)
-      {
-         ret = led_drivers_set_led(dev_led_drivers, i, 100);
-         if (ret != 0) {
-            return -EIO;
-         }
+      ram->hazard_set |= TINYRC_SCENE_BLINKERS & ~(uint32_t)atomic_get(&ram->scene_state);
+      (void)scene_change(ram->hazard_set, 0);
+      if (CONFIG_TINYRC_LINK_HAZARD_TIMEOUT_S > 0) {
+         (void)bus_lib_schedule(&tinyrc_hazard_off_work, 
+            K_SECONDS(CONFIG_TINYRC_LINK_HAZARD_TIMEOUT_S));
       }
+      return;
    }
-   else
-   {
-      // Reset all LEDs and stop any timer work
-      ret = led_drivers_rst(dev_led_drivers);
-      k_work_cancel_delayable(&blinker_work.work);
-      led_def_enabled = false;
+   bus_lib_cancel(&tinyrc_hazard_off_work);
+   tinyrc_hazard_off(NULL);
+#endif
+
+   if (state.connected) {
+      (void)scene_set(TINYRC_SCENE_DEFAULT, true);
    }
-   if (ret != 0) {
-      return ret;
+}
+
+BUS_LIB_OBSERVER_DEFINE(tinyrc_link_obs, tinyrc_link_changed);
+
+static void tinyrc_bat_changed(struct k_work *work)
+{
+   ARG_UNUSED(work);
+   struct bus_bat_state state;
+
+   if (zbus_chan_read(&bus_bat_chan, &state, BUS_LIB_PUB_TIMEOUT) != 0) {
+      return;
+   }
+
+   LOG_DBG("Battery %s, %d mV", (state.status == BAT_CHARGER_STATUS_CHARGING) ? 
+      "charging" : "not charging", (int32_t)state.voltage_mv);
+
+   // The LED drivers pick the lowest charge pump gain the battery allows
+   if (led_drivers_set_supply(dev_led_drivers, state.voltage_mv) != 0) {
+      LOG_ERR("Failed led_drivers_set_supply()");
    }
-   
-   return 0;
 }
 
-int32_t tinyrc_led_set_blinker(tinyrc_blinker_side_t side, bool enable)
+BUS_LIB_OBSERVER_DEFINE(tinyrc_bat_obs, tinyrc_bat_changed);
+
+static void tinyrc_bat_pub(struct k_work *work);
+static BUS_LIB_WORK_DEFINE(tinyrc_bat_pub_work, tinyrc_bat_pub);
+
+// The charger reports in ISR context, the status is read and published from the bus
+// workqueue. The voltage changes without an event, so it is also published periodically
+static void tinyrc_bat_pub(struct k_work *work)
 {
-   int32_t ret = 0;
+   ARG_UNUSED(work);
+   struct bus_bat_state state;
+   int32_t ret = bat_charger_get_status(dev_bat_charger);
 
-   switch (side)
-   {
-   case TINYRC_BLINKER_LEFT:
-      blinker_left_enabled = enable;
-      LOG_INF("Left blinker state = %d", (int32_t)blinker_left_enabled);
-      break;
-   case TINYRC_BLINKER_RIGHT:
-      blinker_right_enabled = enable;
-      LOG_INF("Right blinker state = %d", (int32_t)blinker_right_enabled);
-      break;
-   }
-
-   // Stop blinker work if both blinkers are disabled
-   if ((blinker_left_enabled == false) && (blinker_right_enabled == false)) {
-      k_work_cancel_delayable(&blinker_work.work);
-      blinker_toggle = false;
-      if (led_def_enabled)
-      {
-         ret = tinyrc_led_set_default();
-         if (ret != 0) {
-            return ret;
-         }
-      }
-      else
-      {
-         ret = tinyrc_led_set_allonoff(false);
-         if (ret != 0) {
-            return ret;
-         }
-      }
+   (void)bus_lib_schedule(&tinyrc_bat_pub_work, K_MSEC(TINYRC_BAT_PUB_PERIOD_MS));
+   if (ret < 0) {
+      return;
    }
-   else {
-      k_work_schedule(&blinker_work.work, K_MSEC(TINYRC_LED_BLINKER_PERIOD_MS));
+   state.status = (uint8_t)ret;
+   // Without a battery voltage the LED drivers keep the automatic charge pump gain
+   if (bat_charger_get_voltage(dev_bat_charger, &state.voltage_mv) != 0) {
+      state.voltage_mv = 0;
    }
+   (void)bus_lib_pub(&bus_bat_chan, &state);
+}
 
-   return 0;
+static void tinyrc_bat_cb(const struct device *dev, void *user_data)
+{
+   ARG_UNUSED(dev);
+   ARG_UNUSED(user_data);
+
+   // Rescheduled, a submit would leave it waiting for the periodic publish
+   (void)bus_lib_schedule(&tinyrc_bat_pub_work, K_NO_WAIT);
+}
+
+static void tinyrc_led_async_cb(const struct device *dev, int err, void *user_data)
+{
+   ARG_UNUSED(dev);
+   ARG_UNUSED(user_data);
+
+   LOG_ERR("LED drivers write failed, err: %d", err);
 }
 
-int32_t tinyrc_init(void)
+#if CONFIG_BLE_FAILSAFE
+static void tinyrc_failsafe_handler(ble_failsafe_reason_t reason)
 {
-   k_work_init_delayable(&blinker_work.work, blinker_work_cb);
+   ARG_UNUSED(reason);
+
+   // ISR context, the motors stop without ramping. The stop is published from the bus
+   // workqueue
+   (void)motors_drv_stop(dev_motors_drv);
+   (void)bus_lib_submit(&tinyrc_drive_stopped_work);
+}
+#endif
+
+static int32_t tinyrc_init(void *arena)
+{
+   ram = arena;
+
+   // Behaviours run on the bus workqueue, started before anything can publish
+   if ((bus_lib_init() != 0) || 
+         (bus_lib_observe(&bus_drive_chan, &tinyrc_drive_obs) != 0) || 
+         (bus_lib_observe(&bus_link_chan, &tinyrc_link_obs) != 0) || 
+         (bus_lib_observe(&bus_bat_chan, &tinyrc_bat_obs) != 0)) {
+      LOG_ERR("Failed to set up the event bus");
+   }
+   if (bat_charger_set_callback(dev_bat_charger, tinyrc_bat_cb, NULL) != 0) {
+      LOG_ERR("Failed bat_charger_set_callback()");
+   }
+   (void)bus_lib_submit(&tinyrc_bat_pub_work);
+
+   // LED changes from the shell, BLE and blinkers no longer wait on the I2C bus
+   if ((led_drivers_set_async_callback(dev_led_drivers, tinyrc_led_async_cb, NULL) != 0) || 
+         (led_drivers_set_async(dev_led_drivers, true) != 0)) {
+      LOG_WRN("LED drivers asynchronous writes unavailable");
+   }
+#if CONFIG_TINYRC_LED_HW_BLINK
+   // Both blinkers share the LED drivers blink timing
+   if (led_drivers_set_blink(dev_led_drivers, TINYRC_LED_BLINKER_PERIOD_MS, 
+         2 * TINYRC_LED_BLINKER_PERIOD_MS) != 0) {
+      LOG_ERR("Failed led_drivers_set_blink()");
+   }
+#else
+   if (led_anim_init(dev_led_drivers, anim_timelines, ARRAY_SIZE(anim_timelines)) != 0) {
+      LOG_ERR("Failed led_anim_init()");
+   }
+#endif
+#if CONFIG_BLE_FAILSAFE
+   ble_failsafe_set_handler(tinyrc_failsafe_handler);
+#endif
 
    return 0;
 }
+
+PROFILE_DEFINE(tinyrc, tinyrc_init, struct tinyrc_ram, &tinyrc_led_map, &tinyrc_motor_limits, 
+   tinyrc_shell_cmds);
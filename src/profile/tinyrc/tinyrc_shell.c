@@ -19,7 +19,7 @@
 #include <driver/motors/motors_drv.h>
 
 
-static const struct device *dev_motors_drv = DEVICE_DT_GET_ONE(juskim_motors);
+static const struct device *dev_motors_drv = DEVICE_DT_GET(DT_ALIAS(motors0));
 
 
 static int32_t cmd_m(const struct shell *sh, size_t argc, char **argv)
@@ -54,13 +54,42 @@ static int32_t cmd_m(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
+static int32_t cmd_d(const struct shell *sh, size_t argc, char **argv)
+{
+   ARG_UNUSED(argc);
+   int32_t ret = 0;
+   char *end;
+
+   int32_t arg_throttle = strtol(argv[1], &end, 10);
+   if ((*end != '\0') || (arg_throttle < INT16_MIN) || (arg_throttle > INT16_MAX))
+   {
+      shell_lib_error(sh, "Invalid arg[1]: %s", argv[1]);
+      return -EINVAL;
+   }
+   int32_t arg_steering = strtol(argv[2], &end, 10);
+   if (*end != '\0')
+   {
+      shell_lib_error(sh, "Invalid arg[2]: %s", argv[2]);
+      return -EINVAL;
+   }
+
+   ret = tinyrc_drive(arg_throttle, arg_steering);
+   if (ret != 0)
+   {
+      shell_lib_error(sh, "ret err %d", ret);
+      return -EIO;
+   }
+
+	return 0;
+}
+
 static int32_t cmd_s(const struct shell *sh, size_t argc, char **argv)
 {
    ARG_UNUSED(argc);
    ARG_UNUSED(argv);
    int32_t ret = 0;
 
-   ret = motors_drv_move_dc(dev_motors_drv, MOTOR_DIR_FORWARD, 0);
+   ret = tinyrc_stop();
    if (ret != 0)
    {
       shell_lib_error(sh, "ret err %d", ret);
@@ -73,8 +102,7 @@ static int32_t cmd_s(const struct shell *sh, size_t argc, char **argv)
 static int32_t cmd_l(const struct shell *sh, size_t argc, char **argv)
 {
    const char *cmd_w_param[] = {
-      "def", "on", "off", "bl", "br" };
-   ARG_UNUSED(argc);
+      "def", "on", "off", "bl", "br", "brake", "rev" };
    int32_t ret = 0;
 
    if (strcmp(argv[1], cmd_w_param[0]) == 0) { // def (default LEDs)
@@ -110,6 +138,22 @@ static int32_t cmd_l(const struct shell *sh, size_t argc, char **argv)
          ret = -EINVAL;
       }
    }
+   else if ((strcmp(argv[1], cmd_w_param[5]) == 0) || // brake
+      (strcmp(argv[1], cmd_w_param[6]) == 0)) // rev (reverse)
+   {
+      int32_t (*set)(bool) = (strcmp(argv[1], cmd_w_param[5]) == 0) ? tinyrc_led_set_brake : 
+         tinyrc_led_set_reverse;
+
+      if ((argc > 2) && (strcmp(argv[2], "1") == 0)) {
+         ret = set(true);
+      }
+      else if ((argc > 2) && (strcmp(argv[2], "0") == 0)) {
+         ret = set(false);
+      }
+      else {
+         ret = -EINVAL;
+      }
+   }
    else
    {
       shell_lib_error(sh, "Invalid argument %s", argv[1]);
@@ -125,11 +169,27 @@ static int32_t cmd_l(const struct shell *sh, size_t argc, char **argv)
 	return 0;
 }
 
-
-SHELL_STATIC_SUBCMD_SET_CREATE(tinyrc_cmd,
-	SHELL_CMD_ARG(m, NULL, "tinyrc m(move) [l/r/f/b] [val]", cmd_m, 3, 0),
-	SHELL_CMD_ARG(s, NULL, "tinyrc s(stop)", cmd_s, 1, 0),
-	SHELL_CMD_ARG(l, NULL, "tinyrc l(LED)", cmd_l, 2, 1),
+const struct shell_static_entry tinyrc_shell_cmds[] = {
+	SHELL_CMD_ARG(m, NULL, "rc m(move) [l/r/f/b] [val]", cmd_m, 3, 0),
+	SHELL_CMD_ARG(d, NULL, "rc d(drive) [throttle permille] [steering pos]", cmd_d, 3, 0),
+	SHELL_CMD_ARG(s, NULL, "rc s(stop)", cmd_s, 1, 0),
+	SHELL_CMD_ARG(l, NULL, "rc l(LED)", cmd_l, 2, 1),
 	SHELL_SUBCMD_SET_END // Array terminated
-);
-SHELL_CMD_REGISTER(tinyrc, &tinyrc_cmd, "tinyRC profile cmds", NULL);
\ No newline at end of file
+};
+
+// Same commands under the "tinyrc" root they had before the profile registry
+static void tinyrc_cmds_get(size_t idx, struct shell_static_entry *entry)
+{
+   entry->syntax = NULL;
+   for (size_t i = 0; i <= idx; i++)
+   {
+      if (tinyrc_shell_cmds[i].syntax == NULL) {
+         return;
+      }
+   }
+
+   *entry = tinyrc_shell_cmds[idx];
+}
+
+SHELL_DYNAMIC_CMD_CREATE(tinyrc_cmd, tinyrc_cmds_get);
+SHELL_CMD_REGISTER(tinyrc, &tinyrc_cmd, "tinyRC profile cmds (same as rc)", NULL);
\ No newline at end of file
@@ -0,0 +1,106 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       main.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      Cycles per call of the actuation math, the float conversions the motors and
+ *             LED drivers used before against the integer ones they use now. Both are
+ *             also checked to give the same results.
+ */
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/ztest.h>
+
+#include <driver/motors/motors_drv.h>
+#include <driver/led_drivers/ltc3220.h>
+
+#define BENCH_ITER            1000
+#define BENCH_PER_CNT         101      // Percentages 0 to 100
+// DC motor PWM period of the nimBLE DK ('motors0' pwms) in nanoseconds
+#define BENCH_PWM_PERIOD_NS   5000000
+
+#define BENCH_LVL_LUT_ENTRY(per, _)    LTC3220_PERCENT_TO_LVL(per)
+
+
+// Percent to LED level, built as in ltc3220.c
+static const uint8_t lvl_lut[BENCH_PER_CNT] = {
+   LISTIFY(BENCH_PER_CNT, BENCH_LVL_LUT_ENTRY, (,))
+};
+
+static volatile uint32_t sink;
+
+
+// Old move_dc() + set_dc_pwm(): percent to a float duty cycle, times the PWM period
+static uint32_t __noinline dc_pulse_float(uint8_t duty_per)
+{
+   float duty_cycle = ((float)duty_per) / 100.0;
+
+   return BENCH_PWM_PERIOD_NS * duty_cycle;
+}
+
+// New move_dc() + set_dc_pwm(): percent to permille, MOTORS_DRV_DC_PULSE()
+static uint32_t __noinline dc_pulse_permille(uint8_t duty_per)
+{
+   return MOTORS_DRV_DC_PULSE(BENCH_PWM_PERIOD_NS,
+      duty_per * (MOTORS_DRV_DUTY_PERMILLE_MAX / 100));
+}
+
+// Old ltc3220_set_led(): float division on every register write
+static uint32_t __noinline lvl_float(uint8_t on_percent)
+{
+   return (uint8_t)((((float)on_percent) / 100.0) * ((float)LTC3220_MAX_LED_LVL - 1.0));
+}
+
+// New ltc3220_set_led(): lookup table generated at compile time
+static uint32_t __noinline lvl_table(uint8_t on_percent)
+{
+   return lvl_lut[on_percent];
+}
+
+static uint32_t bench_cycles(uint32_t (*fn)(uint8_t))
+{
+   uint32_t start = k_cycle_get_32();
+
+   for (uint32_t i = 0; i < BENCH_ITER; i++) {
+      sink = fn(i % BENCH_PER_CNT);
+   }
+
+   return (k_cycle_get_32() - start) / BENCH_ITER;
+}
+
+ZTEST(fixed_point, test_dc_pulse)
+{
+   uint32_t cyc_float, cyc_int;
+
+   // Same pulse width, give or take the float rounding
+   for (uint8_t per = 0; per < BENCH_PER_CNT; per++) {
+      zassert_within(dc_pulse_permille(per), dc_pulse_float(per), 1, "Duty cycle %d%%", per);
+   }
+
+   cyc_float = bench_cycles(dc_pulse_float);
+   cyc_int = bench_cycles(dc_pulse_permille);
+   TC_PRINT("duty -> pulse, cycles/call: float %u, permille %u\n", cyc_float, cyc_int);
+}
+
+ZTEST(fixed_point, test_led_level)
+{
+   uint32_t cyc_float, cyc_int;
+
+   // The float path was the linear curve, the table follows the Kconfig selected curve
+   for (uint8_t per = 0; per < BENCH_PER_CNT; per++)
+   {
+      zassert_equal(LTC3220_LVL_LINEAR(per), lvl_float(per), "On percent %d", per);
+      zassert_equal(lvl_table(per), LTC3220_PERCENT_TO_LVL(per), "On percent %d", per);
+   }
+
+   cyc_float = bench_cycles(lvl_float);
+   cyc_int = bench_cycles(lvl_table);
+   TC_PRINT("percent -> level, cycles/call: float %u, table %u\n", cyc_float, cyc_int);
+}
+
+ZTEST_SUITE(fixed_point, NULL, NULL, NULL, NULL, NULL);
\ No newline at end of file
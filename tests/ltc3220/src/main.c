@@ -0,0 +1,259 @@
+/**
+ * \copyright  Copyright 2023 juskim. All rights reserved.
+ *             The code for this project follow the Apache 2.0 license and details 
+ *             are provided in the LICENSE file located in the root folder of this 
+ *             project. Details of SOUP used in this project can also be found in 
+ *             the SOUP file located in the root folder.
+ * 
+ * @file       main.c
+ * @author     juskim (GitHub: jus-kim, YouTube: @juskim)
+ * @brief      LTC3220 driver tests on the I2C emulator. The tinyRC scenes go through the 
+ *             driver and the register image and bus traffic the device receives are 
+ *             checked after each change.
+ */
+#include <zephyr/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/ztest.h>
+
+#include <string.h>
+
+#include <driver/led_drivers/led_drivers.h>
+#include <driver/led_drivers/ltc3220.h>
+#include <driver/led_drivers/ltc3220_emul.h>
+#include <profile/tinyrc.h>
+
+// LED levels of the tinyRC scenes
+#define LVL_DEFAULT        LTC3220_PERCENT_TO_LVL(TINYRC_LED_BRI_DEFAULT_FRONT)
+#define LVL_BRAKE          LTC3220_PERCENT_TO_LVL(TINYRC_LED_BRI_BRAKE)
+#define LVL_REVERSE        LTC3220_PERCENT_TO_LVL(TINYRC_LED_BRI_REVERSE)
+#define LVL_BLINKER        LTC3220_PERCENT_TO_LVL(TINYRC_LED_BRI_BLINKER_FRONT)
+
+// GRAD_BLINK after the default lights fade in: 480 ms ramp up, 625/1250 ms blink
+#define GRAD_BLINK_FADE    ((2 << LTC3220_GRAD_BLINK_GRAD_SHIFT) | LTC3220_GRAD_BLINK_UP_MASK)
+
+
+static const struct device *dev = DEVICE_DT_GET(DT_ALIAS(ltc3220));
+static const struct emul *emul = EMUL_DT_GET(DT_ALIAS(ltc3220));
+
+// LEDs of the tinyRC scenes, as in TINYRC_SCENE_LEDS_*
+static const uint8_t leds_default[] = {
+   TINYRC_LED_RED_F_R, TINYRC_LED_BLU_F_R, TINYRC_LED_GRE_F_R,
+   TINYRC_LED_RED_F_C, TINYRC_LED_BLU_F_C, TINYRC_LED_GRE_F_C,
+   TINYRC_LED_RED_F_L, TINYRC_LED_BLU_F_L, TINYRC_LED_GRE_F_L,
+   TINYRC_LED_RED_B_L, TINYRC_LED_RED_B_C, TINYRC_LED_RED_B_R,
+};
+static const uint8_t leds_brake[] = {
+   TINYRC_LED_RED_B_L, TINYRC_LED_RED_B_C, TINYRC_LED_RED_B_R,
+};
+static const uint8_t leds_reverse[] = {
+   TINYRC_LED_RED_B_C, TINYRC_LED_BLU_B_C, TINYRC_LED_GRE_B_C,
+};
+static const uint8_t leds_blinker_l[] = {
+   TINYRC_LED_RED_F_L, TINYRC_LED_BLU_F_L, TINYRC_LED_GRE_F_L, TINYRC_LED_RED_B_L,
+};
+static const uint8_t leds_blinker_r[] = {
+   TINYRC_LED_RED_F_R, TINYRC_LED_BLU_F_R, TINYRC_LED_GRE_F_R, TINYRC_LED_RED_B_R,
+};
+
+static const uint8_t uled_mode_bits[LED_DRIVERS_MODE_CNT] = {
+   [LED_DRIVERS_MODE_NORMAL] = LTC3220_ULED_MODE_NORMAL,
+   [LED_DRIVERS_MODE_BLINK] = LTC3220_ULED_MODE_BLINK,
+   [LED_DRIVERS_MODE_GRAD] = LTC3220_ULED_MODE_GRAD,
+};
+
+static uint8_t img[LTC3220_TOTAL_LEDS];   // Image last given to the driver
+static struct led_drivers_stats stats_last;
+
+
+static void img_leds(const uint8_t *leds, const size_t count, const uint8_t lvl,
+   const uint8_t mode)
+{
+   for (size_t i = 0; i < count; i++) {
+      img[leds[i]] = LED_DRIVERS_IMG(lvl, mode);
+   }
+}
+
+static void expect_traffic(const uint32_t xfers, const uint32_t bytes)
+{
+   struct ltc3220_emul_traffic traffic;
+   struct led_drivers_stats stats;
+
+   // What the device received, and what the driver counted, since the last check
+   ltc3220_emul_get_traffic(emul, &traffic);
+   zassert_equal(traffic.nacks, 0, "Writes refused: %u", traffic.nacks);
+   zassert_equal(traffic.xfers, xfers, "Transactions: %u, expected %u", traffic.xfers, xfers);
+   zassert_equal(traffic.bytes, bytes, "Bytes: %u, expected %u", traffic.bytes, bytes);
+
+   zassert_ok(led_drivers_get_stats(dev, &stats));
+   zassert_equal(stats.i2c_xfers - stats_last.i2c_xfers, traffic.xfers);
+   zassert_equal(stats.i2c_bytes - stats_last.i2c_bytes, traffic.bytes);
+
+   ltc3220_emul_clear_traffic(emul);
+   stats_last = stats;
+}
+
+static void expect_regs(const uint8_t command, const uint8_t grad_blink)
+{
+   uint8_t regs[LTC3220_REG_CNT];
+
+   ltc3220_emul_get_regs(emul, regs);
+   zassert_equal(regs[LTC3220_COMMAND], command, "COMMAND: 0x%02X, expected 0x%02X",
+      regs[LTC3220_COMMAND], command);
+   for (uint8_t led = 0; led < LTC3220_TOTAL_LEDS; led++)
+   {
+      uint8_t val = uled_mode_bits[LED_DRIVERS_IMG_MODE(img[led])] |
+         LED_DRIVERS_IMG_LVL(img[led]);
+
+      zassert_equal(regs[LTC3220_ULED1 + led], val, "ULED%d: 0x%02X, expected 0x%02X",
+         led + 1, regs[LTC3220_ULED1 + led], val);
+   }
+   zassert_equal(regs[LTC3220_GRAD_BLINK], grad_blink, "GRAD_BLINK: 0x%02X, expected 0x%02X",
+      regs[LTC3220_GRAD_BLINK], grad_blink);
+}
+
+static void show(void)
+{
+   zassert_ok(led_drivers_set_image(dev, 0, LTC3220_TOTAL_LEDS, img));
+}
+
+static void default_lights(void)
+{
+   // As tinyRC turns them on: dark in gradation mode, then ramped up by the device
+   img_leds(leds_default, ARRAY_SIZE(leds_default), LVL_DEFAULT, LED_DRIVERS_MODE_GRAD);
+   show();
+   zassert_ok(led_drivers_set_grad(dev, TINYRC_LED_FADE_MS, true));
+}
+
+static void *ltc3220_setup(void)
+{
+   zassert_true(device_is_ready(dev), "LTC3220 not ready");
+
+   return NULL;
+}
+
+static void ltc3220_before(void *fixture)
+{
+   ARG_UNUSED(fixture);
+
+   // Device and driver both back to the reset state, no traffic counted yet
+   zassert_ok(led_drivers_rst(dev));
+   ltc3220_emul_reset(emul);
+   ltc3220_emul_clear_traffic(emul);
+   zassert_ok(led_drivers_get_stats(dev, &stats_last));
+   memset(img, 0, sizeof(img));
+}
+
+ZTEST(ltc3220, test_default_lights)
+{
+   // Unknown registers: the whole image in one auto-increment burst (2 + 18 bytes), then
+   // COMMAND for the charge pump (3) and GRAD_BLINK to start the ramp (3)
+   default_lights();
+   expect_traffic(3, 26);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   // Nothing changed, nothing sent
+   show();
+   expect_traffic(0, 0);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+}
+
+ZTEST(ltc3220, test_scene_changes)
+{
+   default_lights();
+   expect_traffic(3, 26);
+
+   // Only ULED1..ULED7 go out, the unchanged LEDs in between are part of the burst
+   img_leds(leds_brake, ARRAY_SIZE(leds_brake), LVL_BRAKE, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 7);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   // tinyRC puts LEDs back in normal mode once another scene covered them
+   img_leds(leds_brake, ARRAY_SIZE(leds_brake), LVL_DEFAULT, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 7);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   // ULED4..ULED6
+   img_leds(leds_reverse, ARRAY_SIZE(leds_reverse), LVL_REVERSE, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 3);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   img_leds(leds_reverse, ARRAY_SIZE(leds_reverse), 0, LED_DRIVERS_MODE_NORMAL);
+   img[TINYRC_LED_RED_B_C] = LED_DRIVERS_IMG(LVL_DEFAULT, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 3);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+}
+
+ZTEST(ltc3220, test_blinker_cycle)
+{
+   // Blink timing is set once at start up, 250/500 ms is closest to 625/1250 ms
+   zassert_ok(led_drivers_set_blink(dev, TINYRC_LED_BLINKER_PERIOD_MS,
+      2 * TINYRC_LED_BLINKER_PERIOD_MS));
+   expect_traffic(1, 3);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, 0);
+
+   default_lights();
+   expect_traffic(3, 26);
+
+   // Left blinker: ULED1 and ULED16..ULED18 changed, one burst of ULED1..ULED18
+   img_leds(leds_blinker_l, ARRAY_SIZE(leds_blinker_l), LVL_BLINKER, LED_DRIVERS_MODE_BLINK);
+   show();
+   expect_traffic(1, 2 + 18);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   // The device blinks on its own, no traffic for two of its 1250 ms blink cycles
+   k_msleep(2 * 1250);
+   expect_traffic(0, 0);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   // Hazard: ULED7..ULED12
+   img_leds(leds_blinker_r, ARRAY_SIZE(leds_blinker_r), LVL_BLINKER, LED_DRIVERS_MODE_BLINK);
+   show();
+   expect_traffic(1, 2 + 6);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   img_leds(leds_blinker_l, ARRAY_SIZE(leds_blinker_l), LVL_DEFAULT, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 18);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   img_leds(leds_blinker_r, ARRAY_SIZE(leds_blinker_r), LVL_DEFAULT, LED_DRIVERS_MODE_NORMAL);
+   show();
+   expect_traffic(1, 2 + 6);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+}
+
+ZTEST(ltc3220, test_all_on_off)
+{
+   default_lights();
+   expect_traffic(3, 26);
+
+   // Every LED at the same level: quick-write of COMMAND and ULED1 only
+   memset(img, LED_DRIVERS_IMG(LTC3220_LVL_MAX, LED_DRIVERS_MODE_NORMAL), sizeof(img));
+   show();
+   expect_traffic(1, 2 + 2);
+   expect_regs(LTC3220_COMMAND_QCKWR_MASK | LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+
+   show();
+   expect_traffic(0, 0);
+
+   // All off also shuts the device down, in the same write
+   memset(img, 0, sizeof(img));
+   show();
+   expect_traffic(1, 2 + 2);
+   expect_regs(LTC3220_COMMAND_QCKWR_MASK | LTC3220_COMMAND_SHDWN_MASK, GRAD_BLINK_FADE);
+
+   // Quick-write is turned off in the burst that starts at COMMAND (2 + 1 + 18 bytes),
+   // then the device is woken up (3) and the ramp started (3)
+   default_lights();
+   expect_traffic(3, 21 + 3 + 3);
+   expect_regs(LTC3220_COMMAND_MODE_AUTO, GRAD_BLINK_FADE);
+}
+
+ZTEST_SUITE(ltc3220, NULL, ltc3220_setup, ltc3220_before, NULL, NULL);
\ No newline at end of file